@@ -0,0 +1,146 @@
+/* Copyright 2024 周上行Ryer
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "Fixture.h"
+#include "Logger.h"
+
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QDebug>
+
+namespace Bench {
+
+static std::optional<std::string> read_file(const QString &path) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) { return std::nullopt; }
+    const auto data = file.readAll();
+    return std::string(data.constData(), data.size());
+}
+
+static std::optional<FixtureLabel> parse_label(const json::value &expected) {
+    FixtureLabel label;
+    if (!expected.is_object()) { return std::nullopt; }
+    const auto &obj = expected.as_object();
+
+    if (obj.contains("hit")) {
+        if (!obj.at("hit").is_boolean()) { return std::nullopt; }
+        label.hit = obj.at("hit").as_boolean();
+    }
+
+    if (obj.contains("detail")) { label.detail = obj.at("detail"); }
+
+    if (obj.contains("clicks")) {
+        if (!obj.at("clicks").is_array()) { return std::nullopt; }
+        std::vector<std::array<int, 2>> clicks;
+        for (const auto &point : obj.at("clicks").as_array()) {
+            if (!point.is_array() || point.as_array().size() != 2) { return std::nullopt; }
+            clicks.push_back({point.at(0).as_integer(), point.at(1).as_integer()});
+        }
+        label.clicks = std::move(clicks);
+    }
+
+    return label;
+}
+
+std::optional<std::vector<FixtureSample>> load_fixtures(const QString &fixture_dir) {
+    const QDir dir(fixture_dir);
+
+    const auto opt_labels = read_file(dir.filePath("labels.json"));
+    if (!opt_labels.has_value()) {
+        LOG_ERROR().noquote() << "failed to read" << dir.filePath("labels.json");
+        return std::nullopt;
+    }
+
+    const auto opt_entries = json::parse(opt_labels.value());
+    if (!opt_entries.has_value() || !opt_entries->is_array()) {
+        LOG_ERROR().noquote() << "labels.json must be an array of samples";
+        return std::nullopt;
+    }
+
+    std::vector<FixtureSample> samples;
+    for (const auto &entry : opt_entries->as_array()) {
+        if (!entry.is_object()) { return std::nullopt; }
+        const auto &obj = entry.as_object();
+
+        FixtureSample sample;
+
+        if (!obj.contains("image") || !obj.at("image").is_string()) {
+            LOG_ERROR() << "sample without image:" << QString::fromUtf8(entry.to_string());
+            return std::nullopt;
+        }
+        sample.image_path = dir.filePath(QString::fromUtf8(obj.at("image").as_string()));
+
+        if (false) {
+        } else if (obj.contains("recognizer") && obj.at("recognizer").is_string()) {
+            sample.target    = obj.at("recognizer").as_string();
+            sample.is_action = false;
+        } else if (obj.contains("action") && obj.at("action").is_string()) {
+            sample.target    = obj.at("action").as_string();
+            sample.is_action = true;
+        } else {
+            LOG_ERROR() << "sample without target:" << QString::fromUtf8(entry.to_string());
+            return std::nullopt;
+        }
+
+        sample.param    = obj.get("param", json::object{});
+        sample.override = obj.get("override", json::object{});
+
+        if (obj.contains("expected")) {
+            const auto opt_label = parse_label(obj.at("expected"));
+            if (!opt_label.has_value()) {
+                LOG_ERROR() << "sample with malformed expected field:" << QString::fromUtf8(entry.to_string());
+                return std::nullopt;
+            }
+            sample.label = opt_label.value();
+        }
+
+        auto opt_image = read_file(sample.image_path);
+        if (!opt_image.has_value()) {
+            LOG_ERROR().noquote() << "failed to read fixture image" << sample.image_path;
+            return std::nullopt;
+        }
+        sample.encoded_image = std::move(opt_image).value();
+
+        samples.push_back(std::move(sample));
+    }
+
+    return samples;
+}
+
+bool json_subset_equal(const json::value &expected, const json::value &actual) {
+    if (false) {
+    } else if (expected.is_object()) {
+        if (!actual.is_object()) { return false; }
+        const auto &actual_obj = actual.as_object();
+        for (const auto &[key, value] : expected.as_object()) {
+            if (!actual_obj.contains(key)) { return false; }
+            if (!json_subset_equal(value, actual_obj.at(key))) { return false; }
+        }
+        return true;
+    } else if (expected.is_array()) {
+        if (!actual.is_array()) { return false; }
+        const auto &lhs = expected.as_array();
+        const auto &rhs = actual.as_array();
+        if (lhs.size() != rhs.size()) { return false; }
+        for (size_t i = 0; i < lhs.size(); ++i) {
+            if (!json_subset_equal(lhs.at(i), rhs.at(i))) { return false; }
+        }
+        return true;
+    } else {
+        return expected == actual;
+    }
+}
+
+} // namespace Bench
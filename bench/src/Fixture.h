@@ -0,0 +1,62 @@
+/* Copyright 2024 周上行Ryer
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include <MaaPP/MaaPP.hpp>
+#include <QtCore/QString>
+#include <array>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace Bench {
+
+struct FixtureLabel {
+    std::optional<bool>                            hit;    //<! expected recognition result or action status
+    std::optional<json::value>                     detail; //<! expected recognition detail, compared as a subset
+    std::optional<std::vector<std::array<int, 2>>> clicks; //<! expected click points in issue order
+};
+
+struct FixtureSample {
+    QString      image_path;
+    std::string  encoded_image;
+    std::string  target;    //<! name of the custom recognizer or action under benchmark
+    bool         is_action; //<! true if target names a custom action
+    json::object param;     //<! custom param passed to the target
+    json::object override;  //<! pipeline override applied to the whole run, e.g. to stub out sub-tasks
+    FixtureLabel label;
+
+    bool labeled() const {
+        return label.hit.has_value() || label.detail.has_value() || label.clicks.has_value();
+    }
+};
+
+//! load fixture samples from `<fixture_dir>/labels.json`
+//! NOTE: each entry in labels.json looks like
+//! {
+//!     "image": "xxx.png",                              //<! required, 1280x720 screenshot relative to fixture_dir
+//!     "recognizer": "Research.AnalyzeItemPairs",       //<! either recognizer or action is required
+//!     "action": "Combat.FillSquad",
+//!     "param": {},                                     //<! optional
+//!     "override": {},                                  //<! optional
+//!     "expected": { "hit": true, "detail": {}, "clicks": [[x, y], ...] } //<! optional, all fields are optional
+//! }
+std::optional<std::vector<FixtureSample>> load_fixtures(const QString &fixture_dir);
+
+//! returns true if every field present in expected equals the one in actual
+bool json_subset_equal(const json::value &expected, const json::value &actual);
+
+} // namespace Bench
@@ -0,0 +1,230 @@
+/* Copyright 2024 周上行Ryer
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "Fixture.h"
+#include "Probe.h"
+#include "Stats.h"
+#include "StandInController.h"
+#include "Logger.h"
+#include "ReferenceDataSet.h"
+#include "Rec/Utils.h"
+#include "Rec/Research.h"
+#include "Rec/TemplateMatch.h"
+#include "Action/Combat.h"
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QCommandLineParser>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QTextStream>
+#include <QtCore/QDebug>
+#include <map>
+#include <thread>
+#include <cstdlib>
+
+using namespace Bench;
+
+static bool verify_outcome(const FixtureLabel &label, const ProbeOutcome &outcome, const std::vector<RecordedInput> &inputs) {
+    if (label.hit.has_value() && label.hit.value() != outcome.hit) { return false; }
+
+    if (label.detail.has_value()) {
+        const auto opt_detail = json::parse(outcome.detail);
+        if (!opt_detail.has_value()) { return false; }
+        if (!json_subset_equal(label.detail.value(), opt_detail.value())) { return false; }
+    }
+
+    if (label.clicks.has_value()) {
+        //! NOTE: tolerate small offsets so that labels survive minor roi tweaks
+        constexpr int CLICK_TOLERANCE = 8;
+
+        std::vector<RecordedInput> clicks;
+        for (const auto &input : inputs) {
+            if (input.kind == RecordedInput::Kind::Click) { clicks.push_back(input); }
+        }
+
+        const auto &expected = label.clicks.value();
+        if (clicks.size() != expected.size()) { return false; }
+        for (size_t i = 0; i < clicks.size(); ++i) {
+            if (std::abs(clicks[i].x - expected[i][0]) > CLICK_TOLERANCE) { return false; }
+            if (std::abs(clicks[i].y - expected[i][1]) > CLICK_TOLERANCE) { return false; }
+        }
+    }
+
+    return true;
+}
+
+static json::object merge_pipeline(json::object base, const json::object &patch) {
+    for (const auto &[key, value] : patch) { base[key] = value; }
+    return base;
+}
+
+static void print_report(const std::map<std::string, RecognizerStats> &stats) {
+    QTextStream out(stdout);
+    out << QString::asprintf(
+        "%-40s %6s %9s %9s %9s %9s %10s %10s\n", "target", "runs", "p50(ms)", "p95(ms)", "p99(ms)", "max(ms)", "allocs", "accuracy");
+    for (const auto &[name, stat] : stats) {
+        const auto latency  = stat.latency();
+        const auto accuracy = stat.labeled_samples() == 0
+                                ? QString("-")
+                                : QString("%1/%2").arg(stat.accurate_samples()).arg(stat.labeled_samples());
+        out << QString::asprintf(
+            "%-40s %6zu %9.2f %9.2f %9.2f %9.2f %10.1f %10s\n",
+            name.c_str(),
+            stat.runs(),
+            latency.p50,
+            latency.p95,
+            latency.p99,
+            latency.max,
+            stat.mean_allocations(),
+            accuracy.toUtf8().constData());
+    }
+}
+
+static bool dump_report(const std::map<std::string, RecognizerStats> &stats, const QString &path) {
+    json::array report;
+    for (const auto &[name, stat] : stats) {
+        const auto latency = stat.latency();
+        report.emplace_back(json::object{
+            {"target",           name                                         },
+            {"runs",             static_cast<int64_t>(stat.runs())            },
+            {"samples",          static_cast<int64_t>(stat.samples())         },
+            {"labeled",          static_cast<int64_t>(stat.labeled_samples()) },
+            {"accurate",         static_cast<int64_t>(stat.accurate_samples())},
+            {"p50_ms",           latency.p50                                  },
+            {"p95_ms",           latency.p95                                  },
+            {"p99_ms",           latency.p99                                  },
+            {"max_ms",           latency.max                                  },
+            {"mean_ms",          latency.mean                                 },
+            {"mean_allocations", stat.mean_allocations()                      },
+        });
+    }
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) { return false; }
+    file.write(QByteArray::fromStdString(report.format()));
+    return true;
+}
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("whmx-bench");
+
+    const auto app_dir = QCoreApplication::applicationDirPath();
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Offline benchmark of the custom recognizers and actions over labeled screenshots.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("fixtures", "Directory holding labels.json and the 1280x720 screenshots.");
+
+    QCommandLineOption assets_option("assets", "General assets directory.", "dir", app_dir + "/assets/general");
+    QCommandLineOption data_option("data", "Data assets directory.", "dir", app_dir + "/assets/data");
+    QCommandLineOption repeat_option("repeat", "Measured runs per sample.", "n", "10");
+    QCommandLineOption warmup_option("warmup", "Unmeasured runs per sample.", "n", "1");
+    QCommandLineOption report_option("report", "Write the report to the given json file.", "file");
+    parser.addOptions({assets_option, data_option, repeat_option, warmup_option, report_option});
+    parser.process(app);
+
+    if (parser.positionalArguments().size() != 1) { parser.showHelp(-1); }
+
+    const auto fixture_dir = parser.positionalArguments().front();
+    const int  repeat      = std::max(1, parser.value(repeat_option).toInt());
+    const int  warmup      = std::max(0, parser.value(warmup_option).toInt());
+
+    const auto opt_samples = load_fixtures(fixture_dir);
+    if (!opt_samples.has_value()) { return -1; }
+    const auto &samples = opt_samples.value();
+    LOG_INFO().noquote() << "loaded" << samples.size() << "samples from" << fixture_dir;
+
+    if (const auto anecdotes_path = parser.value(data_option) + "/anecdotes.json";
+        !Ref::ResearchAnecdoteSet::instance()->load(anecdotes_path.toStdString())) {
+        LOG_WARN().noquote() << "failed to load anecdotes set from" << anecdotes_path;
+    }
+
+    auto ev     = std::make_shared<maa::coro::EventLoop>();
+    auto worker = std::thread([ev] {
+        ev->exec();
+    });
+
+    maa::init(QDir(QDir::tempPath()).filePath("whmx-bench").toLocal8Bit().toStdString());
+
+    auto res = maa::Resource::make();
+    if (const auto status = res->post_path(parser.value(assets_option).toStdString())->wait().sync_wait();
+        status != MaaStatus_Success) {
+        LOG_ERROR().noquote() << "failed to load resource from" << parser.value(assets_option);
+        ev->stop();
+        worker.join();
+        return -1;
+    }
+    Rec::TemplateMatch::TemplateCache::instance().reset(parser.value(assets_option).toStdString() + "/image");
+
+    auto stand_in = std::make_shared<StandInController>();
+    auto ctrl     = maa::Controller::make(stand_in);
+    ctrl->post_connect()->wait().sync_wait();
+
+    auto instance = maa::Instance::make()->bind(res)->bind(ctrl);
+    instance->bind<Rec::Utils::TwoStageTest>();
+    instance->bind<Rec::Research::ParseGradeOptionsOnModify>();
+    instance->bind<Rec::Research::ParseAnecdote>();
+    instance->bind<Rec::Research::AnalyzeItemPairs>();
+    instance->bind<Rec::Research::GetCandidateBuffs>();
+    instance->bind<Action::Combat::FillSquad>();
+    instance->bind<RecognizerProbe>();
+    instance->bind<ActionProbe>();
+    Q_ASSERT(instance->inited());
+
+    std::map<std::string, RecognizerStats> stats;
+    for (const auto &sample : samples) {
+        auto &stat = stats.try_emplace(sample.target, sample.target).first->second;
+
+        const auto pipeline = merge_pipeline(sample.override, make_probe_pipeline(sample.target, sample.is_action, sample.param));
+
+        std::optional<ProbeOutcome> last_outcome;
+        std::vector<RecordedInput>  last_inputs;
+        for (int i = 0; i < warmup + repeat; ++i) {
+            stand_in->set_frame(sample.encoded_image);
+            instance->post_task("Bench.Probe", pipeline)->wait().sync_wait();
+            const auto outcome = take_probe_outcome();
+            if (!outcome.has_value()) {
+                LOG_WARN().noquote() << "probe was not reached for" << sample.image_path;
+                break;
+            }
+            if (i < warmup) { continue; }
+            stat.add_run(outcome->elapsed_ms, outcome->allocations);
+            last_outcome = outcome;
+            last_inputs  = stand_in->take_inputs();
+        }
+
+        if (!last_outcome.has_value()) {
+            stat.add_verdict(sample.labeled(), false);
+            continue;
+        }
+
+        const bool accurate = verify_outcome(sample.label, last_outcome.value(), last_inputs);
+        stat.add_verdict(sample.labeled(), accurate);
+        if (sample.labeled() && !accurate) {
+            LOG_WARN().noquote() << "mismatch on" << sample.image_path << "with detail"
+                                 << QString::fromUtf8(last_outcome->detail);
+        }
+    }
+
+    print_report(stats);
+    if (parser.isSet(report_option) && !dump_report(stats, parser.value(report_option))) {
+        LOG_ERROR().noquote() << "failed to write report to" << parser.value(report_option);
+    }
+
+    ev->stop();
+    worker.join();
+    return 0;
+}
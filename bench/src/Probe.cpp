@@ -0,0 +1,155 @@
+/* Copyright 2024 周上行Ryer
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "Probe.h"
+#include "Stats.h"
+#include "Logger.h"
+
+#include <QtCore/QDebug>
+#include <QtCore/QElapsedTimer>
+#include <mutex>
+
+namespace Bench {
+
+using namespace maa;
+
+static constexpr auto PROBE_TASK  = "Bench.Probe";
+static constexpr auto TARGET_TASK = "Bench.Target";
+
+static std::mutex                  PROBE_LOCK;
+static std::optional<ProbeOutcome> PROBE_OUTCOME;
+
+static void post_probe_outcome(ProbeOutcome outcome) {
+    std::lock_guard lock(PROBE_LOCK);
+    PROBE_OUTCOME = std::move(outcome);
+}
+
+static bool parse_probe_param(std::string &target_out, json::object &param_out, std::string_view raw_param) {
+    const auto opt_param = json::parse(raw_param);
+    if (!opt_param.has_value() || !opt_param->is_object()) { return false; }
+    const auto &param = opt_param->as_object();
+    if (!param.contains("target") || !param.at("target").is_string()) { return false; }
+    target_out = param.at("target").as_string();
+    param_out  = param.get("param", json::object{});
+    return true;
+}
+
+json::object make_probe_pipeline(const std::string &target, bool is_action, const json::object &param) {
+    const json::object probe_param{
+        {"target", target},
+        {"param",  param },
+    };
+
+    json::object probe_task;
+    if (is_action) {
+        probe_task["recognition"]         = "DirectHit";
+        probe_task["action"]              = "Custom";
+        probe_task["custom_action"]       = ActionProbe::name();
+        probe_task["custom_action_param"] = probe_param;
+    } else {
+        probe_task["recognition"]              = "Custom";
+        probe_task["custom_recognition"]       = RecognizerProbe::name();
+        probe_task["custom_recognition_param"] = probe_param;
+        probe_task["action"]                   = "DoNothing";
+    }
+    probe_task["next"] = json::array{};
+
+    return json::object{
+        {PROBE_TASK, probe_task},
+    };
+}
+
+std::optional<ProbeOutcome> take_probe_outcome() {
+    std::lock_guard lock(PROBE_LOCK);
+    return std::exchange(PROBE_OUTCOME, std::nullopt);
+}
+
+coro::Promise<AnalyzeResult> RecognizerProbe::bench__recognizer_probe(
+    SyncContextHandle context, ImageHandle image, std::string_view task_name, std::string_view param) {
+    AnalyzeResult resp;
+    resp.result = true;
+
+    std::string  target;
+    json::object target_param;
+    if (!parse_probe_param(target, target_param, param)) {
+        LOG_ERROR().noquote().nospace() << QString::fromUtf8(task_name) << ": invalid arguments";
+        resp.result = false;
+        co_return resp;
+    }
+
+    const json::object pipeline{
+        {TARGET_TASK,
+         json::object{
+             {"recognition", "Custom"},
+             {"custom_recognition", target},
+             {"custom_recognition_param", target_param},
+         }},
+    };
+
+    QElapsedTimer timer;
+    const auto    allocations = allocation_count();
+    timer.start();
+    const auto target_resp = co_await context->run_recognition(image, TARGET_TASK, pipeline);
+    const auto elapsed     = timer.nsecsElapsed();
+
+    post_probe_outcome(ProbeOutcome{
+        .hit         = target_resp.result,
+        .detail      = target_resp.rec_detail,
+        .elapsed_ms  = elapsed / 1e6,
+        .allocations = allocation_count() - allocations,
+    });
+
+    co_return resp;
+}
+
+coro::Promise<bool> ActionProbe::bench__action_probe(
+    std::shared_ptr<SyncContext> context,
+    MaaStringView                task_name,
+    MaaStringView                param,
+    const MaaRect               &cur_box,
+    MaaStringView                cur_rec_detail) {
+    std::string  target;
+    json::object target_param;
+    if (!parse_probe_param(target, target_param, param)) {
+        LOG_ERROR().noquote().nospace() << QString::fromUtf8(task_name) << ": invalid arguments";
+        co_return false;
+    }
+
+    const json::object pipeline{
+        {TARGET_TASK,
+         json::object{
+             {"action", "Custom"},
+             {"custom_action", target},
+             {"custom_action_param", target_param},
+         }},
+    };
+
+    QElapsedTimer timer;
+    const auto    allocations = allocation_count();
+    timer.start();
+    const bool done    = co_await context->run_action(cur_box, cur_rec_detail, TARGET_TASK, pipeline);
+    const auto elapsed = timer.nsecsElapsed();
+
+    post_probe_outcome(ProbeOutcome{
+        .hit         = done,
+        .detail      = "",
+        .elapsed_ms  = elapsed / 1e6,
+        .allocations = allocation_count() - allocations,
+    });
+
+    co_return true;
+}
+
+} // namespace Bench
@@ -0,0 +1,73 @@
+/* Copyright 2024 周上行Ryer
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include <MaaPP/MaaPP.hpp>
+#include <optional>
+#include <string>
+
+namespace Bench {
+
+struct ProbeOutcome {
+    bool        hit;         //<! recognition result or action status of the target
+    std::string detail;      //<! recognition detail of the target, empty for actions
+    double      elapsed_ms;  //<! wall time spent inside the target
+    size_t      allocations; //<! heap allocations made while the target was running
+};
+
+//! build the pipeline override which routes the run through the probe for the given target
+json::object make_probe_pipeline(const std::string &target, bool is_action, const json::object &param);
+
+//! fetch and reset the outcome of the latest probe run
+std::optional<ProbeOutcome> take_probe_outcome();
+
+//! NOTE: the probe is entered with the fixture frame already captured and dispatches the target through the sync
+//! context, so that the measured time excludes screencap, image decoding and pipeline scheduling
+class RecognizerProbe {
+public:
+    static std::string name() {
+        return "Bench.RecognizerProbe";
+    }
+
+    static std::shared_ptr<maa::CustomRecognizer> make() {
+        return maa::CustomRecognizer::make(&RecognizerProbe::bench__recognizer_probe);
+    }
+
+private:
+    static maa::coro::Promise<maa::AnalyzeResult> bench__recognizer_probe(
+        maa::SyncContextHandle context, maa::ImageHandle image, std::string_view task_name, std::string_view param);
+};
+
+class ActionProbe {
+public:
+    static std::string name() {
+        return "Bench.ActionProbe";
+    }
+
+    static std::shared_ptr<maa::CustomAction> make() {
+        return maa::CustomAction::make(&ActionProbe::bench__action_probe);
+    }
+
+private:
+    static maa::coro::Promise<bool> bench__action_probe(
+        std::shared_ptr<maa::SyncContext> context,
+        MaaStringView                     task_name,
+        MaaStringView                     param,
+        const MaaRect                    &cur_box,
+        MaaStringView                     cur_rec_detail);
+};
+
+} // namespace Bench
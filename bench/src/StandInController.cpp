@@ -0,0 +1,84 @@
+/* Copyright 2024 周上行Ryer
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "StandInController.h"
+
+namespace Bench {
+
+using namespace maa;
+
+void StandInController::set_frame(std::string encoded_frame) {
+    std::lock_guard lock(lock_);
+    frame_ = std::move(encoded_frame);
+    inputs_.clear();
+}
+
+std::vector<RecordedInput> StandInController::take_inputs() {
+    std::lock_guard lock(lock_);
+    return std::exchange(inputs_, {});
+}
+
+coro::Promise<bool> StandInController::connect() {
+    co_return true;
+}
+
+coro::Promise<std::optional<std::string>> StandInController::request_uuid() {
+    co_return std::string("whmx-bench.stand-in");
+}
+
+coro::Promise<std::optional<std::tuple<int32_t, int32_t>>> StandInController::request_resolution() {
+    co_return std::make_tuple(FRAME_WIDTH, FRAME_HEIGHT);
+}
+
+coro::Promise<bool> StandInController::start_app(std::string intent) {
+    co_return true;
+}
+
+coro::Promise<bool> StandInController::stop_app(std::string intent) {
+    co_return true;
+}
+
+coro::Promise<bool> StandInController::screencap(ImageHandle image) {
+    std::lock_guard lock(lock_);
+    if (frame_.empty()) { co_return false; }
+    image->set_encoded(frame_);
+    co_return true;
+}
+
+coro::Promise<bool> StandInController::click(int32_t x, int32_t y) {
+    std::lock_guard lock(lock_);
+    inputs_.push_back(RecordedInput{RecordedInput::Kind::Click, x, y});
+    co_return true;
+}
+
+coro::Promise<bool> StandInController::swipe(int32_t x1, int32_t y1, int32_t x2, int32_t y2, int32_t duration) {
+    std::lock_guard lock(lock_);
+    inputs_.push_back(RecordedInput{RecordedInput::Kind::Swipe, x1, y1});
+    co_return true;
+}
+
+coro::Promise<bool> StandInController::touch_down(int32_t contact, int32_t x, int32_t y, int32_t pressure) {
+    co_return true;
+}
+
+coro::Promise<bool> StandInController::touch_move(int32_t contact, int32_t x, int32_t y, int32_t pressure) {
+    co_return true;
+}
+
+coro::Promise<bool> StandInController::touch_up(int32_t contact) {
+    co_return true;
+}
+
+} // namespace Bench
@@ -0,0 +1,63 @@
+/* Copyright 2024 周上行Ryer
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include <MaaPP/MaaPP.hpp>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Bench {
+
+struct RecordedInput {
+    enum class Kind {
+        Click,
+        Swipe,
+    };
+
+    Kind kind;
+    int  x;
+    int  y;
+};
+
+//! stand-in device which replays a fixture frame on every screencap and records the input it receives
+class StandInController : public maa::CustomControllerAPI {
+public:
+    static constexpr int FRAME_WIDTH  = 1280;
+    static constexpr int FRAME_HEIGHT = 720;
+
+    void                       set_frame(std::string encoded_frame);
+    std::vector<RecordedInput> take_inputs();
+
+    maa::coro::Promise<bool>                                         connect() override;
+    maa::coro::Promise<std::optional<std::string>>                   request_uuid() override;
+    maa::coro::Promise<std::optional<std::tuple<int32_t, int32_t>>> request_resolution() override;
+    maa::coro::Promise<bool>                                         start_app(std::string intent) override;
+    maa::coro::Promise<bool>                                         stop_app(std::string intent) override;
+    maa::coro::Promise<bool>                                         screencap(maa::ImageHandle image) override;
+    maa::coro::Promise<bool>                                         click(int32_t x, int32_t y) override;
+    maa::coro::Promise<bool> swipe(int32_t x1, int32_t y1, int32_t x2, int32_t y2, int32_t duration) override;
+    maa::coro::Promise<bool> touch_down(int32_t contact, int32_t x, int32_t y, int32_t pressure) override;
+    maa::coro::Promise<bool> touch_move(int32_t contact, int32_t x, int32_t y, int32_t pressure) override;
+    maa::coro::Promise<bool> touch_up(int32_t contact) override;
+
+private:
+    std::mutex                 lock_;
+    std::string                frame_;
+    std::vector<RecordedInput> inputs_;
+};
+
+} // namespace Bench
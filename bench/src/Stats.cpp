@@ -0,0 +1,95 @@
+/* Copyright 2024 周上行Ryer
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "Stats.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <new>
+#include <numeric>
+
+namespace {
+std::atomic_size_t ALLOCATION_COUNTER{0};
+} // namespace
+
+void *operator new(size_t size) {
+    ALLOCATION_COUNTER.fetch_add(1, std::memory_order_relaxed);
+    if (size == 0) { size = 1; }
+    if (auto ptr = std::malloc(size)) { return ptr; }
+    throw std::bad_alloc();
+}
+
+void *operator new[](size_t size) {
+    return ::operator new(size);
+}
+
+void operator delete(void *ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, size_t size) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr, size_t size) noexcept {
+    std::free(ptr);
+}
+
+namespace Bench {
+
+size_t allocation_count() {
+    return ALLOCATION_COUNTER.load(std::memory_order_relaxed);
+}
+
+static double nearest_rank(const std::vector<double> &sorted, double percentile) {
+    if (sorted.empty()) { return 0.0; }
+    const auto rank = static_cast<size_t>(std::ceil(percentile / 100.0 * sorted.size()));
+    return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+}
+
+void RecognizerStats::add_run(double elapsed_ms, size_t allocations) {
+    latencies_.push_back(elapsed_ms);
+    total_allocations_ += allocations;
+}
+
+void RecognizerStats::add_verdict(bool labeled, bool accurate) {
+    ++total_samples_;
+    if (!labeled) { return; }
+    ++labeled_samples_;
+    if (accurate) { ++accurate_samples_; }
+}
+
+LatencySummary RecognizerStats::latency() const {
+    LatencySummary summary{};
+    if (latencies_.empty()) { return summary; }
+
+    auto sorted = latencies_;
+    std::sort(sorted.begin(), sorted.end());
+
+    summary.p50  = nearest_rank(sorted, 50.0);
+    summary.p95  = nearest_rank(sorted, 95.0);
+    summary.p99  = nearest_rank(sorted, 99.0);
+    summary.max  = sorted.back();
+    summary.mean = std::accumulate(sorted.begin(), sorted.end(), 0.0) / sorted.size();
+    return summary;
+}
+
+} // namespace Bench
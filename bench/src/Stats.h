@@ -0,0 +1,85 @@
+/* Copyright 2024 周上行Ryer
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+namespace Bench {
+
+//! number of heap allocations made through the global operator new since startup
+//! NOTE: the count is process-wide; on linux the replaced operator new is resolved for every shared object, so the
+//! allocations made inside MaaFramework, including those of its own threads during a probe, are counted as well; on
+//! windows the framework dll is linked against its own runtime heap and its allocations are not counted
+size_t allocation_count();
+
+struct LatencySummary {
+    double p50;
+    double p95;
+    double p99;
+    double max;
+    double mean;
+};
+
+class RecognizerStats {
+public:
+    explicit RecognizerStats(std::string name)
+        : name_(std::move(name))
+        , total_samples_(0)
+        , accurate_samples_(0)
+        , labeled_samples_(0)
+        , total_allocations_(0) {}
+
+    const std::string &name() const {
+        return name_;
+    }
+
+    void add_run(double elapsed_ms, size_t allocations);
+    void add_verdict(bool labeled, bool accurate);
+
+    LatencySummary latency() const;
+
+    size_t runs() const {
+        return latencies_.size();
+    }
+
+    double mean_allocations() const {
+        return latencies_.empty() ? 0.0 : static_cast<double>(total_allocations_) / latencies_.size();
+    }
+
+    size_t samples() const {
+        return total_samples_;
+    }
+
+    size_t labeled_samples() const {
+        return labeled_samples_;
+    }
+
+    size_t accurate_samples() const {
+        return accurate_samples_;
+    }
+
+private:
+    std::string         name_;
+    std::vector<double> latencies_;
+    size_t              total_samples_;
+    size_t              accurate_samples_;
+    size_t              labeled_samples_;
+    size_t              total_allocations_;
+};
+
+} // namespace Bench
@@ -15,7 +15,8 @@
 
 #include "Combat.h"
 #include "../Logger.h"
-#include "../Decode.h"
+#include "../FrameStream.h"
+#include "../Rec/TemplateMatch.h"
 
 #include <QtCore/QDebug>
 #include <QtCore/QUuid>
@@ -27,19 +28,6 @@ namespace Action::Combat {
 
 using namespace maa;
 
-static json::object make_template_match_params(
-    const std::string &template_image, const MaaRect &roi = MaaRect{0, 0, 0, 0}, bool green_mask = false) {
-    const json::object params{
-        {"recognition", "TemplateMatch"                                 },
-        {"template",    template_image                                  },
-        {"roi",         json::array{roi.x, roi.y, roi.width, roi.height}},
-        {"green_mask",  green_mask                                      },
-    };
-    return json::object{
-        {"TemplateMatch", params},
-    };
-}
-
 static cv::Mat crop_image(const cv::Mat &src, const MaaRect &rect) {
     return src.rowRange(rect.y, rect.y + rect.height).colRange(rect.x, rect.x + rect.width);
 }
@@ -59,28 +47,37 @@ coro::Promise<bool> FillSquad::combat__fill_squad(
 
     const auto tmp_task_name = QUuid::createUuid().toString().toStdString();
 
-    auto screen = details::Image::make();
-    co_await context->screencap(screen);
+    const auto frame  = co_await FrameStream::capture_recent(context);
+    const auto screen = frame.image;
+
+    //! NOTE: every slot is matched against both templates in a single pass over the screen, queries of the slot i
+    //! are laid out as [locked, free] at 2 * i
+    std::vector<Rec::TemplateMatch::Query> queries;
+    for (int i = 0; i < total_slots; ++i) {
+        const MaaRect slot_roi{squad_roi.x + i * (slot_width + gap_width), squad_roi.y, slot_width, squad_roi.height};
+        queries.push_back(Rec::TemplateMatch::Query{
+            .template_name = locked_slot_template,
+            .roi           = slot_roi,
+            .green_mask    = true,
+        });
+        queries.push_back(Rec::TemplateMatch::Query{
+            .template_name = free_slot_template,
+            .roi           = slot_roi,
+        });
+    }
+    const auto matches = Rec::TemplateMatch::match(screen, queries);
 
     int locked_place = total_slots;
     int joined_slots = 0;
 
     for (int i = 0; i < total_slots; ++i) {
-        const MaaRect slot_roi{squad_roi.x + i * (slot_width + gap_width), squad_roi.y, slot_width, squad_roi.height};
-        {
-            const auto params = make_template_match_params(locked_slot_template, slot_roi, true);
-            const auto resp   = co_await context->run_recognition(screen, "TemplateMatch", params);
-            if (has_expected_match(resp.rec_detail)) {
-                locked_place = i;
-                break;
-            }
-        }
-        {
-            const auto params = make_template_match_params(free_slot_template, slot_roi);
-            const auto resp   = co_await context->run_recognition(screen, "TemplateMatch", params);
-            if (!has_expected_match(resp.rec_detail)) { continue; }
-            ++joined_slots;
+        const auto &slot_roi = queries[2 * i].roi;
+        if (matches[2 * i].hit) {
+            locked_place = i;
+            break;
         }
+        if (!matches[2 * i + 1].hit) { continue; }
+        ++joined_slots;
         co_await context->click(slot_roi.x + slot_roi.width / 2, slot_roi.y + slot_roi.height / 2);
         co_await context->run_task("Combat.JoinSingleRole");
         co_await context->run_task("Combat.WaitSquadLoaded");
@@ -15,6 +15,8 @@
 
 #pragma once
 
+#include "../DeviceSession.h"
+
 #include <MaaPP/MaaPP.hpp>
 
 namespace Action::Combat {
@@ -25,8 +27,8 @@ public:
         return "Combat.FillSquad";
     }
 
-    static std::shared_ptr<maa::CustomAction> make() {
-        return maa::CustomAction::make(&FillSquad::combat__fill_squad);
+    static std::shared_ptr<maa::CustomAction> make(std::shared_ptr<DeviceSession> session = nullptr) {
+        return DeviceSession::wrap_action(session, &FillSquad::combat__fill_squad);
     }
 
 private:
@@ -16,13 +16,15 @@
 #include "FourInRow.h"
 #include "../Logger.h"
 #include "../Algorithm.h"
+#include "../DeviceSession.h"
+#include "../FrameStream.h"
+#include "../Pacing.h"
 
 #include <QtCore/QList>
 #include <QtCore/QMap>
 #include <QtCore/QDebug>
 #include <opencv2/imgproc.hpp>
 #include <optional>
-#include <QtCore/QElapsedTimer>
 
 using namespace maa;
 
@@ -275,7 +277,7 @@ public:
         return value + ucb;
     }
 
-    Move get_move(double temp = 0) const {
+    Move get_move(Xoshiro256 &rng, double temp = 0) const {
         Q_ASSERT(is_root());
         Q_ASSERT(temp >= 0 && temp <= 1);
         if (temp > 1e-6) {
@@ -288,7 +290,7 @@ public:
             QList<double> probs(visit_counts.begin(), visit_counts.end());
             for (auto &prob : probs) { prob = 1.0 / temp * log(prob + 1e-10); }
             probs = softmax(probs);
-            return moves[choice(probs)];
+            return moves[choice(probs, rng)];
         } else {
             int                 best_visit_count = std::numeric_limits<int>::lowest();
             std::optional<Move> best_move;
@@ -320,16 +322,16 @@ static QList<MctsNode::Data> get_guide_by_random_policy(const QList<MctsNode::Mo
     return guide;
 }
 
-static MctsNode::Move sample(const QList<MctsNode::Data> &guide) {
+static MctsNode::Move sample(const QList<MctsNode::Data> &guide, Xoshiro256 &rng) {
     QList<double> probs;
     for (const auto &[_, prob] : guide) { probs.append(prob); }
-    return guide[choice(probs)].move;
+    return guide[choice(probs, rng)].move;
 }
 
-static double rollout(Game &board) {
+static double rollout(Game &board, Xoshiro256 &rng) {
     const int player = board.get_current_player();
     while (true) {
-        const auto move           = sample(get_guide_by_random_policy(board.get_valid_moves()));
+        const auto move           = sample(get_guide_by_random_policy(board.get_valid_moves()), rng);
         const auto [done, winner] = board.evolve(move);
         if (!done) { continue; }
         if (winner == Game::NON_PLAYER) { return 0; }
@@ -337,7 +339,7 @@ static double rollout(Game &board) {
     }
 }
 
-static void run_mcts_once(const Game &board, std::shared_ptr<MctsNode> root) {
+static void run_mcts_once(const Game &board, std::shared_ptr<MctsNode> root, Xoshiro256 &rng) {
     auto cloned_board = board;
     auto node         = root;
 
@@ -356,7 +358,7 @@ static void run_mcts_once(const Game &board, std::shared_ptr<MctsNode> root) {
     if (node->is_root() || !done) {
         const auto valid_moves = cloned_board.get_valid_moves();
         node->expand(get_guide_by_random_policy(valid_moves));
-        neg_leaf_value = rollout(cloned_board);
+        neg_leaf_value = rollout(cloned_board, rng);
     } else if (winner == Game::NON_PLAYER) {
         neg_leaf_value = 0;
     } else {
@@ -438,9 +440,14 @@ coro::Promise<bool> SolveFourInRow::solve_four_in_row(
     const int my_stone    = opt.mode == SolveFourInRowParam::Mode::Black ? black_stone : white_stone;
     const int ai_stone    = opt.mode == SolveFourInRowParam::Mode::Black ? white_stone : black_stone;
 
-    auto get_board_state = [=](std::shared_ptr<details::Image> screen) {
-        context->screencap(screen).sync_wait();
-        const auto im = crop_image(cv::Mat(screen->height(), screen->width(), screen->type(), screen->raw_data()), roi);
+    //! NOTE: the fixed delay once taken after each drop, now only the ceiling of waiting for the ai drop
+    const auto ai_drop_ceiling = std::chrono::milliseconds(2000);
+
+    auto rng = DeviceSession::rng_of(context, task_name);
+
+    auto board_of = [=](const Frame &frame) {
+        const auto screen = frame.image;
+        const auto im     = crop_image(cv::Mat(screen->height(), screen->width(), screen->type(), screen->raw_data()), roi);
 
         Game::Board board;
         for (int row = 0; row < Game::ROW; ++row) {
@@ -460,14 +467,40 @@ coro::Promise<bool> SolveFourInRow::solve_four_in_row(
         return board;
     };
 
-    auto wait = [] {
-        QElapsedTimer tm;
-        tm.start();
-        while (tm.elapsed() < 2000) { std::this_thread::yield(); }
+    //! check whether the board is exactly the expected one plus a single ai stone, which rejects frames taken before our
+    //! own stone is drawn
+    auto is_ai_drop_of = [=](const Game::Board &expected, const Game::Board &board) {
+        int total_new_stones = 0;
+        for (int col = 0; col < Game::COL; ++col) {
+            for (int row = 0; row < Game::ROW; ++row) {
+                const int stone = board[col][row];
+                if (expected[col][row] != Game::NON_PLAYER) {
+                    if (stone != expected[col][row]) { return false; }
+                } else if (stone != Game::NON_PLAYER) {
+                    if (stone != ai_stone) { return false; }
+                    ++total_new_stones;
+                }
+            }
+        }
+        return total_new_stones == 1;
+    };
+
+    //! NOTE: the ai drop has landed once such a board reads the same on two consecutive frames, a stone still falling
+    //! never holds still across frames
+    auto wait_ai_drop = [=](const Game::Board &expected) {
+        std::optional<Game::Board> last_read;
+        return Pacing::wait_until(
+            context,
+            [=](const Frame &frame) mutable {
+                const auto board  = board_of(frame);
+                const bool landed = is_ai_drop_of(expected, board) && last_read == board;
+                last_read         = board;
+                return landed;
+            },
+            ai_drop_ceiling);
     };
 
     bool reenter = false;
-    auto screen  = details::Image::make();
 
     while (true) {
         bool done       = false;
@@ -481,10 +514,14 @@ coro::Promise<bool> SolveFourInRow::solve_four_in_row(
         }
 
         std::optional<Game::Board> opt_last_board;
+        std::optional<Frame>       opt_settled_frame;
         while (!done) {
-            if (!opt_last_board.has_value() && opt.mode == SolveFourInRowParam::Mode::White) { wait(); }
+            if (!opt_last_board.has_value() && opt.mode == SolveFourInRowParam::Mode::White) {
+                opt_settled_frame = (co_await wait_ai_drop(Game::Board{})).frame;
+            }
 
-            const auto board = get_board_state(screen);
+            if (!opt_settled_frame.has_value()) { opt_settled_frame = co_await FrameStream::capture_recent(context); }
+            const auto board = board_of(std::exchange(opt_settled_frame, std::nullopt).value());
 
             Game game;
             game.update(board);
@@ -524,9 +561,9 @@ coro::Promise<bool> SolveFourInRow::solve_four_in_row(
             LOG_INFO().nospace() << "current board state\n" << game;
 
             auto root = std::make_shared<MctsNode>(nullptr, 1.0);
-            for (int i = 0; i < opt.mcts_iters; ++i) { run_mcts_once(game, root); }
+            for (int i = 0; i < opt.mcts_iters; ++i) { run_mcts_once(game, root, rng); }
 
-            const auto mcts_best_move = root->get_move();
+            const auto mcts_best_move = root->get_move(rng);
 
             auto valid_moves_before_drop = game.get_valid_moves();
             valid_moves_before_drop.removeOne(mcts_best_move);
@@ -555,7 +592,7 @@ coro::Promise<bool> SolveFourInRow::solve_four_in_row(
                         LOG_INFO() << "predict ai drop with greedy policy, cancel mcts best drop";
                         game.update(saved_board);
                         game.add_player(ai_stone);
-                        move          = valid_moves_before_drop[choice(0, valid_moves_before_drop.size() - 1)];
+                        move          = valid_moves_before_drop[choice(0, valid_moves_before_drop.size() - 1, rng)];
                         evolve_result = game.evolve(move);
                     }
                 }
@@ -572,7 +609,9 @@ coro::Promise<bool> SolveFourInRow::solve_four_in_row(
             const int click_pos_y = roi.y + (Game::ROW - 1 - move.row) * cell_height + cell_height / 2;
             co_await context->click(click_pos_x, click_pos_y);
 
-            wait();
+            const auto pace = co_await wait_ai_drop(opt_last_board.value());
+            if (!pace.observed && !done) { LOG_WARN() << "ai drop is not observed in" << ai_drop_ceiling.count() << "ms"; }
+            opt_settled_frame = pace.frame;
         }
 
         //! FIXME: in terminated state, sometimes we need quit the finished stage, but sometimes we don't
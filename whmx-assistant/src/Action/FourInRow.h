@@ -13,6 +13,8 @@
    limitations under the License.
 */
 
+#include "../DeviceSession.h"
+
 #include <MaaPP/MaaPP.hpp>
 
 namespace Action {
@@ -35,8 +37,8 @@ public:
         return "SolveFourInRow";
     }
 
-    static std::shared_ptr<maa::CustomAction> make() {
-        return maa::CustomAction::make(&SolveFourInRow::solve_four_in_row);
+    static std::shared_ptr<maa::CustomAction> make(std::shared_ptr<DeviceSession> session = nullptr) {
+        return DeviceSession::wrap_action(session, &SolveFourInRow::solve_four_in_row);
     }
 
     static bool parse_params(SolveFourInRowParam &param_out, MaaStringView raw_param);
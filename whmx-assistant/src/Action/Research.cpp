@@ -16,16 +16,22 @@
 #include "Research.h"
 #include "../Logger.h"
 #include "../Decode.h"
-#include "../Algorithm.h"
+#include "../DeviceSession.h"
+#include "../InputBatch.h"
+#include "../Pacing.h"
 #include "../ReferenceDataSet.h"
+#include "../ResultStore.h"
+#include "../ResearchPlanner.h"
+#include "../FuzzyDictionary.h"
+#include "../Rec/Research.h"
 #include "../Task/Config.h"
 #include "../Task/TaskParam.h"
 
 #include <array>
 #include <vector>
 #include <algorithm>
-#include <random>
 #include <utility>
+#include <random>
 #include <QtCore/QDebug>
 
 namespace Action::Research {
@@ -79,26 +85,25 @@ coro::Promise<bool> SelectGradeOption::research__select_grade_option(
         co_return false;
     }
 
-    struct FaceInfo {
-        int     index;
-        int     grade;
-        MaaRect box;
-    };
-
-    const auto face_data = unwrap_custom_recognizer_analyze_result(cur_rec_detail);
-
-    std::array<FaceInfo, 6> faces;
-    for (const auto &obj : face_data.as_array()) {
-        const auto &face_in  = obj.as_object();
-        const int   index    = face_in.at("index").as_integer();
-        auto       &face_out = faces[index];
-        face_out.index       = index;
-        face_out.grade       = face_in.at("grade").as_integer();
-        const auto &box      = face_in.at("box").as_array();
-        face_out.box.x       = box[0].as_integer();
-        face_out.box.y       = box[1].as_integer();
-        face_out.box.width   = box[2].as_integer();
-        face_out.box.height  = box[3].as_integer();
+    using FaceInfo = Rec::Research::GradeFace;
+
+    //! NOTE: the detail is only decoded when the action is not triggered by the paired recognizer
+    Rec::Research::GradeFaces faces;
+    if (auto stored = ResultStore::instance().take<Rec::Research::GradeFaces>(context, task_name)) {
+        faces = stored.value();
+    } else {
+        for (const auto &obj : unwrap_custom_recognizer_analyze_result(cur_rec_detail).as_array()) {
+            const auto &face_in  = obj.as_object();
+            const int   index    = face_in.at("index").as_integer();
+            auto       &face_out = faces[index];
+            face_out.index       = index;
+            face_out.grade       = face_in.at("grade").as_integer();
+            const auto &box      = face_in.at("box").as_array();
+            face_out.box.x       = box[0].as_integer();
+            face_out.box.y       = box[1].as_integer();
+            face_out.box.width   = box[2].as_integer();
+            face_out.box.height  = box[3].as_integer();
+        }
     }
 
     int total_max_grade     = 0;
@@ -123,7 +128,7 @@ coro::Promise<bool> SelectGradeOption::research__select_grade_option(
         return lhs.grade < rhs.grade;
     });
 
-    std::mt19937 rng(std::random_device{}());
+    auto rng = DeviceSession::rng_of(context, task_name);
 
     int selected_face = -1;
     switch (opt.mode) {
@@ -197,53 +202,55 @@ coro::Promise<bool> ResolveAnecdote::research__resolve_anecdote(
     const int first_opt_y = 400;
     const int opt_dy      = 68;
 
-    const auto anecdote_data = unwrap_custom_recognizer_analyze_result(cur_rec_detail);
-
-    const auto category = anecdote_data.at("category").as_string();
-    const auto name     = anecdote_data.at("name").as_string();
-    const int  stage    = anecdote_data.at("stage").as_integer();
+    std::string category;
+    std::string name;
+    int         stage = -1;
+    if (auto stored = ResultStore::instance().take<Rec::Research::AnecdoteMatch>(context, task_name)) {
+        category = std::move(stored->category);
+        name     = std::move(stored->name);
+        stage    = stored->stage;
+    } else {
+        const auto anecdote_data = unwrap_custom_recognizer_analyze_result(cur_rec_detail);
+        category                 = anecdote_data.at("category").as_string();
+        name                     = anecdote_data.at("name").as_string();
+        stage                    = anecdote_data.at("stage").as_integer();
+    }
 
     const auto &anecdote_entry = Ref::ResearchAnecdoteSet::instance()->entry(category).value().get().entry(name).value().get();
 
-    int current_stage = stage;
-    while (current_stage >= 0 && current_stage < anecdote_entry.total_stages()) {
-        const auto &event_stage = anecdote_entry.stage(current_stage);
-        if (event_stage.options.empty()) {
+    //! NOTE: the choices are planned once the anecdote set is loaded, each stage is resolved with a table lookup; the
+    //! walk is bounded by the number of stages in case the entry is cyclic
+    auto rng           = DeviceSession::rng_of(context, task_name);
+    int  current_stage = stage;
+    for (int step = 0; step < anecdote_entry.total_stages(); ++step) {
+        if (current_stage < 0 || current_stage >= anecdote_entry.total_stages()) { break; }
+
+        auto planned = anecdote_entry.planned_choice(current_stage);
+        if (planned.option == -1) {
             LOG_ERROR() << "no options for stage" << current_stage << "of anecdote" << category << name;
             co_return false;
         }
 
-        int best_choice = -1;
-        if (event_stage.has_recommended_option()) {
-            best_choice = event_stage.recommended;
-        } else {
-            for (int i = 0; i < event_stage.options.size(); ++i) {
-                if (event_stage.options[i].positive) {
-                    best_choice = i;
-                    break;
-                }
-            }
-        }
-        if (best_choice == -1) {
+        if (planned.random) {
             LOG_WARN() << "no positive option for stage" << current_stage << "of anecdote" << category << name
                        << ", make random choice";
-            best_choice = choice(0, event_stage.options.size() - 1);
+            const auto &options = anecdote_entry.stage(current_stage).options;
+            planned.option      = std::uniform_int_distribution<int>(0, options.size() - 1)(rng);
+            const int next      = options[planned.option].next_entry_hint;
+            planned.next_stage  = next >= 0 && next < anecdote_entry.total_stages() ? next : -1;
         }
 
-        const auto &option = event_stage.options[best_choice];
-
         //! TODO: check whether the given option is valid
-        const int click_y_pos = first_opt_y + best_choice * opt_dy + opt_size_h / 2;
+        const int click_y_pos = first_opt_y + planned.option * opt_dy + opt_size_h / 2;
         const int click_x_pos = opt_x + opt_size_w / 4;
 
         co_await context->click(click_x_pos, click_y_pos);
 
         //! FIXME: not support random option yet
 
-        const bool has_next = option.next_entry_hint >= 0 && option.next_entry_hint < anecdote_entry.total_stages();
-        if (has_next) { co_await context->run_task("Research.ResolveResultOfAnecdoteChoice"); }
+        if (planned.next_stage != -1) { co_await context->run_task("Research.ResolveResultOfAnecdoteChoice"); }
 
-        current_stage = option.next_entry_hint;
+        current_stage = planned.next_stage;
     }
 
     co_await context->run_task("Research.ResolveGotExtraResourceOnEventDone");
@@ -264,15 +271,27 @@ coro::Promise<bool> PerformItemPairsMatch::research__perform_item_pairs_match(
     const int     roi_width  = roi_all.width / n_hori;
     const int     roi_height = roi_all.height / n_vert;
 
-    std::vector<std::pair<int, int>> item_pairs;
-    for (const auto data = unwrap_custom_recognizer_analyze_result(cur_rec_detail); const auto &pair : data.as_array()) {
-        item_pairs.push_back({pair.at(0).as_integer(), pair.at(1).as_integer()});
+    Rec::Research::ItemPairs item_pairs;
+    if (auto stored = ResultStore::instance().take<Rec::Research::ItemPairs>(context, task_name)) {
+        item_pairs = std::move(stored.value());
+    } else {
+        for (const auto data = unwrap_custom_recognizer_analyze_result(cur_rec_detail); const auto &pair : data.as_array()) {
+            item_pairs.push_back({pair.at(0).as_integer(), pair.at(1).as_integer()});
+        }
     }
 
     LOG_TRACE() << "wait matching game to start";
     co_await context->run_task("Research.WaitMatchingGameToStart");
 
     LOG_TRACE() << "perform item pairs match";
+    //! NOTE: the fixed delays once taken after each tap are kept as the ceilings, normally the tapped item is seen to
+    //! flip or vanish and holds still much earlier
+    //! NOTE: taps are not batched here, a tap landing before the former item flips is dropped by the game, so every tap
+    //! is confirmed on screen before the next one is sent
+    using namespace std::chrono_literals;
+    const std::array<std::chrono::milliseconds, 2> tap_ceilings{250ms, 1250ms};
+
+    auto reference = co_await FrameStream::capture_recent(context);
     for (const auto &pair : item_pairs) {
         LOG_TRACE().noquote() << QString("match pair (%1)[row=%2,col=%3], (%4)[row=%5,col=%6]")
                                      .arg(pair.first)
@@ -281,20 +300,36 @@ coro::Promise<bool> PerformItemPairsMatch::research__perform_item_pairs_match(
                                      .arg(pair.second)
                                      .arg(pair.second / n_hori + 1)
                                      .arg(pair.second % n_hori + 1);
-        for (const int item : std::initializer_list<int>{pair.first, pair.second}) {
-            const int row      = item / n_hori;
-            const int col      = item % n_hori;
-            const int center_x = roi_all.x + col * roi_width + roi_width / 2;
-            const int center_y = roi_all.y + row * roi_height + roi_height / 2;
-            co_await context->click(center_x, center_y);
-            std::this_thread::sleep_for(std::chrono::milliseconds(250));
+        const std::array<int, 2> items{pair.first, pair.second};
+        for (size_t i = 0; i < items.size(); ++i) {
+            const int     row = items[i] / n_hori;
+            const int     col = items[i] % n_hori;
+            const MaaRect roi{roi_all.x + col * roi_width, roi_all.y + row * roi_height, roi_width, roi_height};
+
+            InputBatch batch;
+            batch.tap(roi.x + roi.width / 2, roi.y + roi.height / 2);
+            if (!co_await InputInjector::submit(context, std::move(batch))) { co_return false; }
+
+            const auto pace = co_await Pacing::settle_after_change(context, reference, roi, tap_ceilings[i]);
+            if (!pace.observed) { LOG_TRACE() << "item" << items[i] << "is not seen to change, proceed on ceiling"; }
+            reference = pace.frame;
         }
-        std::this_thread::sleep_for(std::chrono::milliseconds(1000));
     }
 
     co_return true;
 }
 
+coro::Promise<bool> BeginRun::research__begin_run(
+    std::shared_ptr<SyncContext> context,
+    MaaStringView                task_name,
+    MaaStringView                param,
+    const MaaRect               &cur_box,
+    MaaStringView                cur_rec_detail) {
+    //! NOTE: only a fresh start begins a research run, a continued run keeps the buffs collected before
+    ResearchPlanner::of(context)->begin_run();
+    co_return true;
+}
+
 coro::Promise<bool> ResolveBuffSelection::research__resolve_buff_selection(
     std::shared_ptr<SyncContext> context,
     MaaStringView                task_name,
@@ -310,8 +345,12 @@ coro::Promise<bool> ResolveBuffSelection::research__resolve_buff_selection(
     }
 
     QStringList buff_names;
-    for (const auto data = unwrap_custom_recognizer_analyze_result(cur_rec_detail); const auto &buff : data.as_array()) {
-        buff_names.append(QString::fromUtf8(buff.as_string()));
+    if (const auto stored = ResultStore::instance().take<Rec::Research::CandidateBuffs>(context, task_name)) {
+        for (const auto &buff : stored.value()) { buff_names.append(QString::fromStdString(buff)); }
+    } else {
+        for (const auto data = unwrap_custom_recognizer_analyze_result(cur_rec_detail); const auto &buff : data.as_array()) {
+            buff_names.append(QString::fromUtf8(buff.as_string()));
+        }
     }
 
     const int center_pos_x = 640;
@@ -332,26 +371,29 @@ coro::Promise<bool> ResolveBuffSelection::research__resolve_buff_selection(
         co_return false;
     }
 
-    QList<int> choices;
+    auto planner = ResearchPlanner::of(context);
 
+    //! NOTE: ocr'd buff names are mapped to the closest preferred buff, so that a misread character does not drop the
+    //! preference, and the planner sees the same name for the same buff across rounds
+    //! NOTE: the dictionary only knows the preferred buffs, so any other buff close to one of them would be taken for it;
+    //! a single edit is tolerated on names of three characters or more, and shorter names must match exactly
+    QStringList canonical_names;
+    {
+        FuzzyDictionary preference_dict;
+        for (int i = 0; i < preferred_buffs.size(); ++i) { preference_dict.insert(preferred_buffs[i].toStdString(), i); }
+        for (const auto &buff_name : buff_names) {
+            const int  max_distance = buff_name.toUcs4().size() >= 3 ? 1 : 0;
+            const auto match        = preference_dict.lookup(buff_name.toStdString(), max_distance);
+            canonical_names.append(match.has_value() ? preferred_buffs[match->id] : buff_name);
+        }
+    }
+
+    QList<int> choices;
     if (need_select) {
         Q_ASSERT(choice_expected > 0);
-        for (const auto &preferred_buff : preferred_buffs) {
-            const int index = buff_names.indexOf(preferred_buff);
-            if (index == -1) { continue; }
-            choices.append(index);
-            if (choices.size() >= choice_expected) { break; }
-        }
-        Q_ASSERT(choices.size() <= choice_expected);
-        if (choices.size() < choice_expected) {
-            QList<int> candidates;
-            for (int i = 0; i < buff_names.size(); ++i) {
-                if (choices.contains(i)) { continue; }
-                candidates.append(i);
-            }
-            const auto indicies = multi_choice(choice_expected, 0, candidates.size() - 1);
-            for (const int index : indicies) { choices.append(candidates[index]); }
-        }
+        auto rng = DeviceSession::rng_of(context, task_name);
+        choices  = planner->plan_buff_selection(canonical_names, choice_expected, preferred_buffs, rng);
+        Q_ASSERT(choices.size() == choice_expected);
     } else {
         choices.append(0);
     }
@@ -363,13 +405,17 @@ coro::Promise<bool> ResolveBuffSelection::research__resolve_buff_selection(
     }
 
     if (need_select) {
+        InputBatch batch;
         for (const int choice_index : choices) {
             const int pos_x = center_pos_x + dx * (choice_index - buff_names.size() / 2);
-            co_await context->click(pos_x, pos_y);
+            batch.tap(pos_x, pos_y);
         }
+        if (!co_await InputInjector::submit(context, std::move(batch))) { co_return false; }
         co_await context->run_task("Research.ConfirmBuffSelection");
     }
 
+    planner->observe_buff_offer(canonical_names, choices);
+
     co_await context->run_task("Research.ResolveGotBuff");
 
     co_return true;
@@ -15,6 +15,8 @@
 
 #pragma once
 
+#include "../DeviceSession.h"
+
 #include <MaaPP/MaaPP.hpp>
 
 namespace Action::Research {
@@ -41,8 +43,8 @@ public:
         return "Research.SelectGradeOption";
     }
 
-    static std::shared_ptr<maa::CustomAction> make() {
-        return maa::CustomAction::make(&SelectGradeOption::research__select_grade_option);
+    static std::shared_ptr<maa::CustomAction> make(std::shared_ptr<DeviceSession> session = nullptr) {
+        return DeviceSession::wrap_action(session, &SelectGradeOption::research__select_grade_option);
     }
 
     static bool parse_params(SelectGradeOptionParam &param_out, MaaStringView raw_param);
@@ -64,8 +66,8 @@ public:
         return "Research.ResolveAnecdote";
     }
 
-    static std::shared_ptr<maa::CustomAction> make() {
-        return maa::CustomAction::make(&ResolveAnecdote::research__resolve_anecdote);
+    static std::shared_ptr<maa::CustomAction> make(std::shared_ptr<DeviceSession> session = nullptr) {
+        return DeviceSession::wrap_action(session, &ResolveAnecdote::research__resolve_anecdote);
     }
 
     static bool parse_params(ResolveAnecdoteParam &param_out, MaaStringView raw_param);
@@ -85,8 +87,8 @@ public:
         return "Research.PerformItemPairsMatch";
     }
 
-    static std::shared_ptr<maa::CustomAction> make() {
-        return maa::CustomAction::make(&PerformItemPairsMatch::research__perform_item_pairs_match);
+    static std::shared_ptr<maa::CustomAction> make(std::shared_ptr<DeviceSession> session = nullptr) {
+        return DeviceSession::wrap_action(session, &PerformItemPairsMatch::research__perform_item_pairs_match);
     }
 
 private:
@@ -98,14 +100,33 @@ private:
         MaaStringView                     cur_rec_detail);
 };
 
+class BeginRun {
+public:
+    static std::string name() {
+        return "Research.BeginRun";
+    }
+
+    static std::shared_ptr<maa::CustomAction> make(std::shared_ptr<DeviceSession> session = nullptr) {
+        return DeviceSession::wrap_action(session, &BeginRun::research__begin_run);
+    }
+
+private:
+    static maa::coro::Promise<bool> research__begin_run(
+        std::shared_ptr<maa::SyncContext> context,
+        MaaStringView                     task_name,
+        MaaStringView                     param,
+        const MaaRect                    &cur_box,
+        MaaStringView                     cur_rec_detail);
+};
+
 class ResolveBuffSelection {
 public:
     static std::string name() {
         return "Research.ResolveBuffSelection";
     }
 
-    static std::shared_ptr<maa::CustomAction> make() {
-        return maa::CustomAction::make(&ResolveBuffSelection::research__resolve_buff_selection);
+    static std::shared_ptr<maa::CustomAction> make(std::shared_ptr<DeviceSession> session = nullptr) {
+        return DeviceSession::wrap_action(session, &ResolveBuffSelection::research__resolve_buff_selection);
     }
 
 private:
@@ -18,6 +18,7 @@
 #include <vector>
 #include <algorithm>
 #include <random>
+#include <QtCore/QHash>
 
 int min_edit_distance(const QString &src, const QString &dst) {
     const int m = dst.length() + 1;
@@ -50,13 +51,12 @@ QList<double> softmax(const QList<double> &vec) {
     return probs;
 }
 
-int choice(const QList<double> &weights) {
+int choice(const QList<double> &weights, Xoshiro256 &rng) {
     if (weights.empty()) { return -1; }
     QList<double> acc_weights;
     acc_weights.append(weights.front());
     for (int i = 1; i < weights.size(); ++i) { acc_weights.append(acc_weights[i - 1] + weights[i]); }
-    auto         dist = std::uniform_real_distribution<double>(0, acc_weights.back());
-    std::mt19937 rng(std::random_device{}());
+    auto         dist  = std::uniform_real_distribution<double>(0, acc_weights.back());
     const double value = dist(rng);
     for (int i = 0; i < weights.size(); ++i) {
         if (value <= acc_weights[i]) { return i; }
@@ -64,20 +64,25 @@ int choice(const QList<double> &weights) {
     return weights.size() - 1;
 }
 
-int choice(int min_index, int max_index) {
-    std::mt19937 rng(std::random_device{}());
-    return rng() % (max_index - min_index + 1) + min_index;
+int choice(int min_index, int max_index, Xoshiro256 &rng) {
+    return std::uniform_int_distribution<int>(min_index, max_index)(rng);
 }
 
-QList<int> multi_choice(int n, int min_index, int max_index) {
-    //! TODO: better algorithm
-    const int expected = std::min(std::max(1, n), max_index - min_index + 1);
+QList<int> multi_choice(int n, int min_index, int max_index, Xoshiro256 &rng) {
+    const int total    = max_index - min_index + 1;
+    const int expected = std::min(std::max(1, n), total);
     Q_ASSERT(expected == n);
-    QList<int> choices;
-    while (choices.size() < expected) {
-        const int value = choice(min_index, max_index);
-        if (choices.contains(value)) { continue; }
-        choices.append(value);
+
+    //! NOTE: partial fisher-yates over the virtual array [0, total), only the swapped slots are stored so that the cost
+    //! is O(n) regardless of the range
+    QHash<int, int> swapped;
+    QList<int>      choices;
+    choices.reserve(expected);
+    for (int i = 0; i < expected; ++i) {
+        const int j     = choice(i, total - 1, rng);
+        const int value = swapped.value(j, j);
+        swapped.insert(j, swapped.value(i, i));
+        choices.append(value + min_index);
     }
     return choices;
 }
@@ -15,6 +15,8 @@
 
 #pragma once
 
+#include "Random.h"
+
 #include <QtCore/QString>
 #include <QtCore/QList>
 #include <algorithm>
@@ -22,9 +24,9 @@
 
 int           min_edit_distance(const QString &src, const QString &dst);
 QList<double> softmax(const QList<double> &vec);
-int           choice(const QList<double> &weights);
-int           choice(int min_index, int max_index);
-QList<int>    multi_choice(int n, int min_index, int max_index);
+int           choice(const QList<double> &weights, Xoshiro256 &rng);
+int           choice(int min_index, int max_index, Xoshiro256 &rng);
+QList<int>    multi_choice(int n, int min_index, int max_index, Xoshiro256 &rng);
 double        eval_color_distance(const int (&lhs_rgb)[3], const int (&rhs_rgb)[3]);
 
 template <typename Container, typename T>
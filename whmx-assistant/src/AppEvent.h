@@ -39,6 +39,7 @@ signals:
     void workbench_on_open_maa_log_file();
     void workbench_on_open_app_log_file();
     void workbench_on_post_queued_task(QString task_id, QVariant task);
+    void workbench_on_stop_pipeline();
     void workbench_on_request_open_task_config_panel(Task::MajorTask task);
     void workbench_on_accept_maa_instance(std::shared_ptr<maa::Instance> instance);
     void workbench_on_notify_queued_task_accepted(QString task_id);
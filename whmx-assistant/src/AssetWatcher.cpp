@@ -0,0 +1,118 @@
+/* Copyright 2024 周上行Ryer
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "AssetWatcher.h"
+#include "Logger.h"
+
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDebug>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <algorithm>
+
+void AssetWatcher::watch(const QString &path) {
+    const auto root = QDir::cleanPath(QFileInfo(path).absoluteFilePath());
+    if (roots_.contains(root)) { return; }
+    roots_.append(root);
+    scan(root, true);
+}
+
+void AssetWatcher::handle_on_path_changed(const QString &path) {
+    dirty_paths_.insert(path);
+    debounce_timer_->start();
+}
+
+void AssetWatcher::handle_on_flush() {
+    const auto dirty_paths = std::exchange(dirty_paths_, {});
+
+    //! NOTE: a changed directory may have gained files, removed files are found by the hash lookup below
+    for (const auto &path : dirty_paths) {
+        if (QFileInfo(path).isDir()) { scan(path, false); }
+    }
+
+    QStringList changed_files;
+    QStringList removed_files;
+    for (const auto &[file_path, hash] : file_hashes_.asKeyValueRange()) {
+        const bool under_dirty = std::any_of(dirty_paths.begin(), dirty_paths.end(), [&file_path](const QString &path) {
+            return file_path == path || file_path.startsWith(path + '/');
+        });
+        if (!under_dirty) { continue; }
+        if (!QFileInfo::exists(file_path)) {
+            removed_files.append(file_path);
+        } else if (const auto new_hash = hash_of(file_path); new_hash != hash) {
+            changed_files.append(file_path);
+        }
+    }
+    for (const auto &file_path : removed_files) { file_hashes_.remove(file_path); }
+    for (const auto &file_path : changed_files) { file_hashes_[file_path] = hash_of(file_path); }
+
+    //! NOTE: editors which replace the file on save drop the watch, so re-arm every known file
+    const auto          watched_files = watcher_->files();
+    const QSet<QString> watched(watched_files.begin(), watched_files.end());
+    for (const auto &file_path : file_hashes_.keys()) {
+        if (!watched.contains(file_path)) { watcher_->addPath(file_path); }
+    }
+
+    if (changed_files.empty() && removed_files.empty()) { return; }
+    LOG_INFO() << "asset watcher:" << changed_files.size() << "files changed," << removed_files.size() << "files removed";
+    emit on_assets_changed(changed_files, removed_files);
+}
+
+AssetWatcher::AssetWatcher(QObject *parent)
+    : QObject(parent)
+    , watcher_(new QFileSystemWatcher(this))
+    , debounce_timer_(new QTimer(this)) {
+    debounce_timer_->setSingleShot(true);
+    debounce_timer_->setInterval(DEBOUNCE_MS);
+    connect(watcher_, &QFileSystemWatcher::fileChanged, this, &AssetWatcher::handle_on_path_changed);
+    connect(watcher_, &QFileSystemWatcher::directoryChanged, this, &AssetWatcher::handle_on_path_changed);
+    connect(debounce_timer_, &QTimer::timeout, this, &AssetWatcher::handle_on_flush);
+}
+
+void AssetWatcher::scan(const QString &path, bool initial) {
+    const QFileInfo info(path);
+    if (!info.exists()) { return; }
+
+    QStringList files;
+    if (info.isFile()) {
+        files.append(QDir::cleanPath(info.absoluteFilePath()));
+    } else {
+        QList<QDir> stack;
+        stack.append(QDir(QDir::cleanPath(info.absoluteFilePath())));
+        while (!stack.empty()) {
+            const auto dir = stack.takeLast();
+            watcher_->addPath(dir.absolutePath());
+            for (const auto &entry : dir.entryList(QDir::Dirs | QDir::NoDotAndDotDot)) {
+                stack.append(QDir(dir.absoluteFilePath(entry)));
+            }
+            for (const auto &entry : dir.entryList(QDir::Files)) { files.append(dir.absoluteFilePath(entry)); }
+        }
+    }
+
+    for (const auto &file_path : files) {
+        //! NOTE: files found by a rescan are new, an empty hash makes the next flush report them as changed
+        if (!file_hashes_.contains(file_path)) { file_hashes_.insert(file_path, initial ? hash_of(file_path) : QString()); }
+        watcher_->addPath(file_path);
+    }
+}
+
+QString AssetWatcher::hash_of(const QString &file_path) const {
+    QFile file(file_path);
+    if (!file.open(QIODevice::ReadOnly)) { return QString(); }
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    hash.addData(&file);
+    return hash.result().toHex();
+}
@@ -0,0 +1,57 @@
+/* Copyright 2024 周上行Ryer
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include <QtCore/QObject>
+#include <QtCore/QFileSystemWatcher>
+#include <QtCore/QTimer>
+#include <QtCore/QMap>
+#include <QtCore/QSet>
+#include <QtCore/QStringList>
+
+//! watches asset files and reports the files whose content actually changed
+//! NOTE: notifications are debounced, and a file is only reported when its content hash differs from the last seen
+//! one, so that editors which save through temp files or touch files without modifying them do not cause reloads
+class AssetWatcher : public QObject {
+    Q_OBJECT
+
+public:
+    static constexpr int DEBOUNCE_MS = 200;
+
+    //! watch the file, or every file under the directory recursively
+    void watch(const QString &path);
+
+signals:
+    void on_assets_changed(QStringList changed_files, QStringList removed_files);
+
+protected slots:
+    void handle_on_path_changed(const QString &path);
+    void handle_on_flush();
+
+public:
+    AssetWatcher(QObject *parent = nullptr);
+
+protected:
+    void    scan(const QString &path, bool initial);
+    QString hash_of(const QString &file_path) const;
+
+private:
+    QFileSystemWatcher    *watcher_;
+    QTimer                *debounce_timer_;
+    QStringList            roots_;
+    QSet<QString>          dirty_paths_;
+    QMap<QString, QString> file_hashes_; //<! path -> content hash of the last seen version
+};
@@ -16,6 +16,9 @@
 #include "Decode.h"
 
 #include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <vector>
 
 std::optional<OcrRecord> parse_and_get_best_ocr_record(const json::value &result) {
     if (!result.contains("all")) { return std::nullopt; }
@@ -87,6 +90,301 @@ bool has_expected_match(const json::value &result) {
     return !best.as_object().empty();
 }
 
-bool has_expected_match(const std::string &result) {
-    return has_expected_match(json::parse(result).value_or(json::object()));
+//! forward-only reader over a json text, values are either read or skipped in place
+class DetailReader {
+public:
+    explicit DetailReader(std::string_view text)
+        : text_(text)
+        , pos_(0) {}
+
+    char peek() {
+        skip_spaces();
+        return pos_ < text_.size() ? text_[pos_] : '\0';
+    }
+
+    bool consume(char ch) {
+        if (peek() != ch) { return false; }
+        ++pos_;
+        return true;
+    }
+
+    //! reads the next key of the current object, false at the end of the object or on malformed input
+    //! NOTE: keys of the known schemas are plain ascii, so they are compared raw without unescaping
+    bool next_key(std::string_view &key, bool &first) {
+        if (consume('}')) { return false; }
+        if (!first && !consume(',')) { return false; }
+        first = false;
+        if (!consume('"')) { return false; }
+        const auto end = text_.find('"', pos_);
+        if (end == std::string_view::npos) { return false; }
+        key  = text_.substr(pos_, end - pos_);
+        pos_ = end + 1;
+        return consume(':');
+    }
+
+    //! steps to the next element of the current array, false at the end of the array or on malformed input
+    bool next_element(bool &first) {
+        if (consume(']')) { return false; }
+        if (!first && !consume(',')) { return false; }
+        first = false;
+        return true;
+    }
+
+    bool read_number(double &out) {
+        skip_spaces();
+        const auto *begin            = text_.data() + pos_;
+        const auto *end              = text_.data() + text_.size();
+        const auto [ptr, error_code] = std::from_chars(begin, end, out);
+        if (error_code != std::errc{}) { return false; }
+        pos_ += ptr - begin;
+        return true;
+    }
+
+    bool read_string(std::string &out) {
+        if (!consume('"')) { return false; }
+        out.clear();
+        while (pos_ < text_.size()) {
+            const char ch = text_[pos_++];
+            if (ch == '"') { return true; }
+            if (ch != '\\') {
+                out.push_back(ch);
+                continue;
+            }
+            if (pos_ >= text_.size()) { return false; }
+            switch (const char escaped = text_[pos_++]) {
+                case 'b': {
+                    out.push_back('\b');
+                } break;
+                case 'f': {
+                    out.push_back('\f');
+                } break;
+                case 'n': {
+                    out.push_back('\n');
+                } break;
+                case 'r': {
+                    out.push_back('\r');
+                } break;
+                case 't': {
+                    out.push_back('\t');
+                } break;
+                case 'u': {
+                    uint32_t code = 0;
+                    if (!read_hex4(code)) { return false; }
+                    if (code >= 0xd800 && code < 0xdc00) {
+                        uint32_t low = 0;
+                        if (!consume_raw("\\u") || !read_hex4(low)) { return false; }
+                        code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+                    }
+                    append_utf8(out, code);
+                } break;
+                default: {
+                    out.push_back(escaped);
+                } break;
+            }
+        }
+        return false;
+    }
+
+    bool skip_value() {
+        const char ch = peek();
+        if (ch == '"') {
+            ++pos_;
+            while (pos_ < text_.size()) {
+                const char next = text_[pos_++];
+                if (next == '\\') {
+                    ++pos_;
+                } else if (next == '"') {
+                    return true;
+                }
+            }
+            return false;
+        }
+        if (ch != '{' && ch != '[') {
+            //! NOTE: number, true, false or null
+            while (pos_ < text_.size() && std::string_view(",}] \t\r\n").find(text_[pos_]) == std::string_view::npos) {
+                ++pos_;
+            }
+            return true;
+        }
+        int depth = 0;
+        while (pos_ < text_.size()) {
+            const char next = text_[pos_];
+            if (next == '"') {
+                if (!skip_value()) { return false; }
+                continue;
+            }
+            ++pos_;
+            if (next == '{' || next == '[') { ++depth; }
+            if (next == '}' || next == ']') { --depth; }
+            if (depth == 0) { return true; }
+        }
+        return false;
+    }
+
+private:
+    void skip_spaces() {
+        while (pos_ < text_.size() && std::string_view(" \t\r\n").find(text_[pos_]) != std::string_view::npos) { ++pos_; }
+    }
+
+    bool consume_raw(std::string_view token) {
+        if (text_.substr(pos_, token.size()) != token) { return false; }
+        pos_ += token.size();
+        return true;
+    }
+
+    bool read_hex4(uint32_t &out) {
+        if (pos_ + 4 > text_.size()) { return false; }
+        const auto *begin            = text_.data() + pos_;
+        const auto [ptr, error_code] = std::from_chars(begin, begin + 4, out, 16);
+        if (error_code != std::errc{} || ptr != begin + 4) { return false; }
+        pos_ += 4;
+        return true;
+    }
+
+    static void append_utf8(std::string &out, uint32_t code) {
+        if (false) {
+        } else if (code < 0x80) {
+            out.push_back(static_cast<char>(code));
+        } else if (code < 0x800) {
+            out.push_back(static_cast<char>(0xc0 | (code >> 6)));
+            out.push_back(static_cast<char>(0x80 | (code & 0x3f)));
+        } else if (code < 0x10000) {
+            out.push_back(static_cast<char>(0xe0 | (code >> 12)));
+            out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3f)));
+            out.push_back(static_cast<char>(0x80 | (code & 0x3f)));
+        } else {
+            out.push_back(static_cast<char>(0xf0 | (code >> 18)));
+            out.push_back(static_cast<char>(0x80 | ((code >> 12) & 0x3f)));
+            out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3f)));
+            out.push_back(static_cast<char>(0x80 | (code & 0x3f)));
+        }
+    }
+
+    std::string_view text_;
+    size_t           pos_;
+};
+
+struct OcrDetail {
+    bool                     has_all;
+    std::vector<OcrRecord>   all;
+    std::optional<OcrRecord> best;
+};
+
+//! reads {"box": [x, y, w, h], "score": s, "text": t}, an empty object is not a record
+static bool read_ocr_record(DetailReader &reader, std::optional<OcrRecord> &out) {
+    if (!reader.consume('{')) { return reader.skip_value(); }
+
+    OcrRecord        record{};
+    bool             has_fields = false;
+    bool             first      = true;
+    std::string_view key;
+    while (reader.next_key(key, first)) {
+        has_fields = true;
+        if (false) {
+        } else if (key == "text") {
+            if (!reader.read_string(record.text)) { return false; }
+        } else if (key == "score") {
+            if (!reader.read_number(record.score)) { return false; }
+        } else if (key == "box") {
+            if (!reader.consume('[')) { return false; }
+            bool first_element = true;
+            for (int i = 0; reader.next_element(first_element); ++i) {
+                double value = 0;
+                if (!reader.read_number(value)) { return false; }
+                if (i < record.box.size()) { record.box[i] = static_cast<int>(value); }
+            }
+        } else if (!reader.skip_value()) {
+            return false;
+        }
+    }
+
+    if (has_fields) { out = std::move(record); }
+    return true;
+}
+
+//! NOTE: "all" is only materialized when requested, otherwise it is skipped as a whole
+static bool decode_ocr_detail(std::string_view rec_detail, bool with_all, OcrDetail &detail_out) {
+    DetailReader reader(rec_detail);
+    if (!reader.consume('{')) { return false; }
+
+    detail_out.has_all = false;
+
+    bool             first = true;
+    std::string_view key;
+    while (reader.next_key(key, first)) {
+        if (false) {
+        } else if (key == "best") {
+            if (!read_ocr_record(reader, detail_out.best)) { return false; }
+        } else if (key == "all" && with_all) {
+            detail_out.has_all = true;
+            if (!reader.consume('[')) { return false; }
+            bool first_element = true;
+            while (reader.next_element(first_element)) {
+                std::optional<OcrRecord> record;
+                if (!read_ocr_record(reader, record)) { return false; }
+                if (record.has_value()) { detail_out.all.push_back(std::move(record.value())); }
+            }
+        } else {
+            if (key == "all") { detail_out.has_all = true; }
+            if (!reader.skip_value()) { return false; }
+        }
+    }
+    return true;
+}
+
+std::optional<OcrRecord> decode_ocr_best(std::string_view rec_detail) {
+    OcrDetail detail;
+    if (!decode_ocr_detail(rec_detail, false, detail)) { return std::nullopt; }
+    return detail.best;
+}
+
+std::optional<OcrRecord> decode_best_ocr_record(std::string_view rec_detail) {
+    OcrDetail detail;
+    if (!decode_ocr_detail(rec_detail, true, detail) || !detail.has_all) { return std::nullopt; }
+    if (detail.best.has_value()) { return detail.best; }
+    if (detail.all.empty()) { return std::nullopt; }
+    return *std::max_element(detail.all.begin(), detail.all.end(), [](const auto &lhs, const auto &rhs) {
+        return lhs.score < rhs.score;
+    });
+}
+
+std::optional<OcrRecord> decode_full_text_ocr_result(std::string_view rec_detail) {
+    OcrDetail detail;
+    if (!decode_ocr_detail(rec_detail, true, detail) || !detail.has_all) { return std::nullopt; }
+
+    auto &records = detail.all;
+    std::stable_sort(records.begin(), records.end(), [](const auto &lhs, const auto &rhs) {
+        return lhs.box[1] < rhs.box[1];
+    });
+
+    double weighted_score = 0.0;
+    int    total_chars    = 0;
+
+    OcrRecord resp{};
+    for (const auto &record : records) {
+        resp.text      += record.text;
+        weighted_score += record.text.size() * record.score;
+        total_chars    += record.text.size();
+    }
+    resp.score = weighted_score / std::max(total_chars, 1);
+
+    return std::make_optional(resp);
+}
+
+bool has_expected_match(const std::string &rec_detail) {
+    DetailReader reader(rec_detail);
+    if (!reader.consume('{')) { return false; }
+
+    bool             first = true;
+    std::string_view key;
+    while (reader.next_key(key, first)) {
+        if (key != "best") {
+            if (!reader.skip_value()) { return false; }
+            continue;
+        }
+        //! NOTE: the rest of the detail is irrelevant once the best one is found
+        if (!reader.consume('{')) { return false; }
+        return reader.peek() != '}';
+    }
+    return false;
 }
@@ -15,17 +15,30 @@
 
 #pragma once
 
+#include <array>
 #include <string>
+#include <string_view>
 #include <optional>
 #include <meojson/json.hpp>
 
 struct OcrRecord {
-    std::string text;
-    double      score;
+    std::string        text;
+    double             score;
+    std::array<int, 4> box; //<! x, y, width, height
 };
 
 std::optional<OcrRecord> parse_and_get_best_ocr_record(const json::value &result);
 std::optional<OcrRecord> parse_and_get_full_text_ocr_result(const json::value &result);
 json::value              unwrap_custom_recognizer_analyze_result(std::string_view rec_detail);
 bool                     has_expected_match(const json::value &result);
-bool                     has_expected_match(const std::string &result);
+
+//! NOTE: the decoders below read the raw detail of the maa OCR and TemplateMatch recognitions in a single forward pass,
+//! only the fields of the known schemas are extracted and everything else is skipped without building a json dom
+
+//! the "best" record, std::nullopt if there is none
+std::optional<OcrRecord> decode_ocr_best(std::string_view rec_detail);
+//! the "best" record, or the record with the highest score in "all" if there is no best one
+std::optional<OcrRecord> decode_best_ocr_record(std::string_view rec_detail);
+//! texts of "all" joined from top to bottom, the score is weighted by the text length
+std::optional<OcrRecord> decode_full_text_ocr_result(std::string_view rec_detail);
+bool                     has_expected_match(const std::string &rec_detail);
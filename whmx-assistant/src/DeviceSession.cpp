@@ -0,0 +1,149 @@
+/* Copyright 2024 周上行Ryer
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "DeviceSession.h"
+#include "Logger.h"
+#include "Trace.h"
+#include "Metrics.h"
+#include "ResultStore.h"
+
+#include <QtCore/QDebug>
+#include <shared_mutex>
+#include <unordered_map>
+
+using namespace maa;
+
+static std::shared_mutex                                                     CONTEXT_SESSIONS_LOCK;
+static std::unordered_map<const SyncContext *, std::weak_ptr<DeviceSession>> CONTEXT_SESSIONS;
+
+//! binds the context to the session while the callback is running
+class ContextBinding {
+public:
+    ContextBinding(const SyncContextHandle &context, const std::shared_ptr<DeviceSession> &session)
+        : context_(context.get()) {
+        std::unique_lock lock(CONTEXT_SESSIONS_LOCK);
+        CONTEXT_SESSIONS[context_] = session;
+    }
+
+    ~ContextBinding() {
+        std::unique_lock lock(CONTEXT_SESSIONS_LOCK);
+        CONTEXT_SESSIONS.erase(context_);
+    }
+
+private:
+    const SyncContext *context_;
+};
+
+static coro::Promise<AnalyzeResult> analyze_in_session(
+    std::shared_ptr<DeviceSession>        session,
+    const CustomRecognizer::analyze_func &func,
+    SyncContextHandle                     context,
+    ImageHandle                           image,
+    std::string_view                      task_name,
+    std::string_view                      param) {
+    Trace::Span span("rec", task_name);
+    if (session) { span.attr("device", session->address()); }
+    const Metrics::Labels      labels{{"task", std::string(task_name)}};
+    const Metrics::ScopedTimer timer(Metrics::Registry::instance().histogram("whmx_recognizer_duration_seconds", labels));
+    const ContextBinding       binding(context, session);
+    //! NOTE: the result of an earlier hit whose action never ran must not survive into this run, whether it hits or not
+    ResultStore::instance().clear(context, task_name);
+    co_return co_await func(context, image, task_name, param);
+}
+
+static coro::Promise<bool> run_in_session(
+    std::shared_ptr<DeviceSession> session,
+    const CustomAction::run_func  &func,
+    std::shared_ptr<SyncContext>   context,
+    MaaStringView                  task_name,
+    MaaStringView                  param,
+    MaaRect                        cur_box,
+    MaaStringView                  cur_rec_detail) {
+    Trace::Span span("action", task_name);
+    if (session) { span.attr("device", session->address()); }
+    auto                      &registry = Metrics::Registry::instance();
+    const Metrics::Labels      labels{{"task", std::string(task_name)}};
+    const Metrics::ScopedTimer timer(registry.histogram("whmx_action_duration_seconds", labels));
+    const ContextBinding       binding(context, session);
+    const bool                 done = co_await func(context, task_name, param, cur_box, cur_rec_detail);
+    if (!done) { registry.counter("whmx_action_failures_total", labels).inc(); }
+    co_return done;
+}
+
+std::shared_ptr<DeviceSession>
+    DeviceSession::create(std::string address, std::shared_ptr<Controller> ctrl, std::shared_ptr<Resource> res) {
+    auto instance = Instance::make()->bind(res)->bind(ctrl);
+    if (!instance->inited()) {
+        LOG_ERROR().noquote() << "failed to init maa instance for device" << QString::fromStdString(address);
+        return nullptr;
+    }
+    return std::shared_ptr<DeviceSession>(new DeviceSession(std::move(address), ctrl, instance));
+}
+
+std::shared_ptr<DeviceSession> DeviceSession::of(const SyncContextHandle &context) {
+    std::shared_lock lock(CONTEXT_SESSIONS_LOCK);
+    if (const auto it = CONTEXT_SESSIONS.find(context.get()); it != CONTEXT_SESSIONS.end()) { return it->second.lock(); }
+    return nullptr;
+}
+
+Xoshiro256 DeviceSession::rng_of(const SyncContextHandle &context, std::string_view task_name) {
+    if (auto session = of(context)) { return session->rng(task_name); }
+    return Random::stream(task_name, 0);
+}
+
+std::shared_ptr<CustomRecognizer>
+    DeviceSession::wrap_recognizer(std::shared_ptr<DeviceSession> session, CustomRecognizer::analyze_func func) {
+    if (!session) { return CustomRecognizer::make(func); }
+    //! NOTE: the session holds the instance which holds the recognizer, keep a weak reference to break the cycle
+    return CustomRecognizer::make([weak_session = std::weak_ptr(session), func](
+                                      SyncContextHandle context, ImageHandle image, std::string_view task_name,
+                                      std::string_view param) {
+        return analyze_in_session(weak_session.lock(), func, context, image, task_name, param);
+    });
+}
+
+std::shared_ptr<CustomAction> DeviceSession::wrap_action(std::shared_ptr<DeviceSession> session, CustomAction::run_func func) {
+    if (!session) { return CustomAction::make(func); }
+    return CustomAction::make([weak_session = std::weak_ptr(session), func](
+                                  std::shared_ptr<SyncContext> context, MaaStringView task_name, MaaStringView param,
+                                  const MaaRect &cur_box, MaaStringView cur_rec_detail) {
+        return run_in_session(weak_session.lock(), func, context, task_name, param, cur_box, cur_rec_detail);
+    });
+}
+
+DeviceSession::DeviceSession(std::string address, std::shared_ptr<Controller> ctrl, std::shared_ptr<Instance> instance)
+    : address_(std::move(address))
+    , ctrl_(ctrl)
+    , instance_(instance)
+    , frame_stream_(FrameStream::create(ctrl))
+    , input_injector_(InputInjector::create(ctrl))
+    , research_planner_(ResearchPlanner::create()) {}
+
+DeviceSession::~DeviceSession() {
+    stop();
+    ResultStore::instance().drop_scope(this);
+}
+
+Xoshiro256 DeviceSession::rng(std::string_view task_name) {
+    std::lock_guard lock(rng_lock_);
+    auto            it = task_draws_.find(task_name);
+    if (it == task_draws_.end()) { it = task_draws_.emplace(std::string(task_name), 0).first; }
+    return Random::stream(task_name, it->second++);
+}
+
+void DeviceSession::stop() {
+    frame_stream_->stop();
+    input_injector_->stop();
+}
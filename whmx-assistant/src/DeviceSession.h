@@ -0,0 +1,106 @@
+/* Copyright 2024 周上行Ryer
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include "FrameStream.h"
+#include "InputBatch.h"
+#include "ResearchPlanner.h"
+#include "Random.h"
+
+#include <MaaPP/MaaPP.hpp>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+//! one connected device, i.e. a controller together with the instance running on it
+//! NOTE: sessions share the loaded resource, so that every extra device costs a controller and an instance instead of
+//! another copy of the models
+//! NOTE: custom recognizers and actions bound through a session know which device they are running on, see
+//! DeviceSession::of
+class DeviceSession : public std::enable_shared_from_this<DeviceSession> {
+public:
+    //! returns nullptr when the instance failed to init
+    static std::shared_ptr<DeviceSession>
+        create(std::string address, std::shared_ptr<maa::Controller> ctrl, std::shared_ptr<maa::Resource> res);
+
+    //! find the session of the device which the context is running on, nullptr if the callback is not bound through a
+    //! session
+    static std::shared_ptr<DeviceSession> of(const maa::SyncContextHandle &context);
+
+    //! wrap the callback so that DeviceSession::of resolves to the session during the call, a null session leaves the
+    //! callback untouched
+    static std::shared_ptr<maa::CustomRecognizer>
+        wrap_recognizer(std::shared_ptr<DeviceSession> session, maa::CustomRecognizer::analyze_func func);
+    static std::shared_ptr<maa::CustomAction>
+        wrap_action(std::shared_ptr<DeviceSession> session, maa::CustomAction::run_func func);
+
+    //! generator of the session the context is running on for one run of the task, falls back to the first stream of the
+    //! task if the callback is not bound through a session
+    static Xoshiro256 rng_of(const maa::SyncContextHandle &context, std::string_view task_name);
+
+    template <typename T>
+        requires requires { T::name(); } && requires { T::make(std::shared_ptr<DeviceSession>{}); }
+    std::shared_ptr<DeviceSession> bind() {
+        instance_->bind(T::name(), T::make(shared_from_this()));
+        return shared_from_this();
+    }
+
+    ~DeviceSession();
+
+    void stop();
+
+    const std::string &address() const {
+        return address_;
+    }
+
+    std::shared_ptr<maa::Controller> controller() const {
+        return ctrl_;
+    }
+
+    std::shared_ptr<maa::Instance> instance() const {
+        return instance_;
+    }
+
+    std::shared_ptr<FrameStream> frame_stream() const {
+        return frame_stream_;
+    }
+
+    std::shared_ptr<InputInjector> input_injector() const {
+        return input_injector_;
+    }
+
+    std::shared_ptr<ResearchPlanner> research_planner() const {
+        return research_planner_;
+    }
+
+    //! the n-th call for a task takes the n-th stream of the task name, so that the draws replay with the session seed
+    Xoshiro256 rng(std::string_view task_name);
+
+protected:
+    DeviceSession(std::string address, std::shared_ptr<maa::Controller> ctrl, std::shared_ptr<maa::Instance> instance);
+
+private:
+    std::string                      address_;
+    std::shared_ptr<maa::Controller> ctrl_;
+    std::shared_ptr<maa::Instance>   instance_;
+    std::shared_ptr<FrameStream>     frame_stream_;
+    std::shared_ptr<InputInjector>   input_injector_;
+    std::shared_ptr<ResearchPlanner> research_planner_;
+
+    std::mutex                                   rng_lock_;
+    std::map<std::string, uint64_t, std::less<>> task_draws_;
+};
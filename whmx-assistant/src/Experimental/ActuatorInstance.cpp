@@ -0,0 +1,150 @@
+/* Copyright 2024 周上行Ryer
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "ActuatorInstance.h"
+#include "ResourceCache.h"
+
+#include <QtCore/QFile>
+#include <gsl/gsl>
+#include <algorithm>
+#include <vector>
+
+namespace Experimental {
+
+using Clock = std::chrono::steady_clock;
+
+static std::mutex                              UMA_PROPERTIES_LOCK;
+static std::vector<std::weak_ptr<UmaProperty>> UMA_PROPERTIES;
+
+std::shared_ptr<UmaProperty> UmaProperty::create(std::shared_ptr<Package> package) {
+    auto prop = std::shared_ptr<UmaProperty>(new UmaProperty(package));
+    {
+        std::lock_guard lock(UMA_PROPERTIES_LOCK);
+        std::erase_if(UMA_PROPERTIES, [](const auto &prop) {
+            return prop.expired();
+        });
+        UMA_PROPERTIES.push_back(prop);
+    }
+    return prop;
+}
+
+void UmaProperty::trim(int max_loaded) {
+    std::vector<std::pair<Clock::time_point, std::shared_ptr<UmaProperty>>> idle_props;
+    {
+        std::lock_guard lock(UMA_PROPERTIES_LOCK);
+        for (const auto &weak_prop : UMA_PROPERTIES) {
+            const auto prop = weak_prop.lock();
+            if (!prop) { continue; }
+            //! NOTE: a property held by its prefetch is busy loading rather than idle, skip it instead of waiting on it
+            std::unique_lock prop_lock(prop->lock_, std::try_to_lock);
+            if (!prop_lock.owns_lock()) { continue; }
+            if (prop->pinned_ || !prop->loaded()) { continue; }
+            idle_props.emplace_back(prop->last_used_, prop);
+        }
+    }
+    if (idle_props.size() <= static_cast<size_t>(max_loaded)) { return; }
+
+    std::sort(idle_props.begin(), idle_props.end(), [](const auto &lhs, const auto &rhs) {
+        return lhs.first > rhs.first;
+    });
+    for (size_t i = max_loaded; i < idle_props.size(); ++i) { idle_props[i].second->evict(); }
+}
+
+std::shared_ptr<Package> UmaProperty::package() const {
+    return package_;
+}
+
+std::shared_ptr<TaskInterface> UmaProperty::interface() {
+    std::lock_guard lock(lock_);
+    touch();
+    if (!interface_) {
+        const QDir package_dir(package_->location());
+        interface_ = package_dir.exists("task.json") ? TaskInterface::load(package_dir.absoluteFilePath("task.json"))
+                                                     : std::make_shared<TaskInterface>();
+    }
+    return interface_;
+}
+
+std::shared_ptr<TaskGraph> UmaProperty::task_graph() {
+    std::lock_guard lock(lock_);
+    touch();
+    if (!task_graph_) {
+        task_graph_ = std::make_shared<TaskGraph>();
+        //! NOTE: a package which failed to materialize is left with an empty graph
+        if (const auto dir = ResourceCache::resource_dir(*package_)) {
+            const QDir pipeline_dir(dir->absoluteFilePath("pipeline"));
+            for (const auto &entry : pipeline_dir.entryList(QDir::Files)) {
+                task_graph_->merge_pipeline(pipeline_dir.absoluteFilePath(entry));
+            }
+        }
+    }
+    return task_graph_;
+}
+
+std::shared_ptr<TaskRouter> UmaProperty::task_router() {
+    std::lock_guard lock(lock_);
+    touch();
+    if (!task_router_) {
+        task_router_ = TaskRouter::create(task_graph(), interface()->prop_context);
+        const QDir package_dir(package_->location());
+        QFile      file(package_dir.absoluteFilePath("router.json"));
+        Expects(file.open(QIODevice::ReadOnly));
+        const auto opt_json = json::parse(file.readAll());
+        Expects(opt_json);
+        const auto &json = opt_json.value();
+        Expects(json.is_object());
+        task_router_->reload(json.as_object());
+    }
+    return task_router_;
+}
+
+void UmaProperty::pin(bool on) {
+    std::lock_guard lock(lock_);
+    pinned_ = on;
+    touch();
+}
+
+bool UmaProperty::loaded() {
+    std::lock_guard lock(lock_);
+    return task_graph_ || task_router_;
+}
+
+void UmaProperty::evict() {
+    std::lock_guard lock(lock_);
+    if (pinned_) { return; }
+    //! NOTE: the interface is kept since it carries the property values, only the pieces rebuilt from the package go
+    task_graph_.reset();
+    task_router_.reset();
+}
+
+void UmaProperty::prefetch() {
+    maa::coro::EventLoop::current()->eval([weak_prop = weak_from_this()] {
+        const auto prop = weak_prop.lock();
+        if (!prop) { return; }
+        std::ignore = prop->task_router();
+        UmaProperty::trim();
+    });
+}
+
+UmaProperty::UmaProperty(std::shared_ptr<Package> package)
+    : package_(package)
+    , pinned_(false)
+    , last_used_(Clock::now()) {}
+
+void UmaProperty::touch() {
+    last_used_ = Clock::now();
+}
+
+} // namespace Experimental
@@ -27,7 +27,9 @@
 #include <QtCore/QUuid>
 #include <QtCore/QDir>
 #include <QtGui/QColor>
+#include <chrono>
 #include <memory>
+#include <mutex>
 
 namespace Experimental {
 
@@ -37,20 +39,45 @@ struct MaaProperty {
     std::shared_ptr<::maa::Controller> ctrl;
 };
 
-struct UmaProperty {
-    std::shared_ptr<Package>       package;
-    std::shared_ptr<TaskInterface> interface;
-    std::shared_ptr<TaskGraph>     task_graph;
-    std::shared_ptr<TaskRouter>    task_router;
-
-    static std::shared_ptr<UmaProperty> create(std::shared_ptr<Package> package) {
-        QDir package_dir(package->location());
-        auto prop       = std::make_shared<UmaProperty>();
-        prop->package   = package;
-        prop->interface = package_dir.exists("task.json") ? TaskInterface::load(package_dir.absoluteFilePath("task.json"))
-                                                          : std::make_shared<TaskInterface>();
-        return prop;
-    }
+//! package-bound pieces of an uma instance, each piece is loaded on first use
+//! NOTE: the graph and the router of an idle instance may be evicted at any time and are simply reloaded on the next
+//! use, pin the property while the instance is active; the interface carries the property values and stays resident
+class UmaProperty : public std::enable_shared_from_this<UmaProperty> {
+public:
+    static constexpr int MAX_IDLE_LOADED = 2; //<! max idle properties which keep their pieces loaded
+
+    static std::shared_ptr<UmaProperty> create(std::shared_ptr<Package> package);
+
+    //! evict the least recently used idle properties until at most max_loaded of them hold loaded pieces
+    static void trim(int max_loaded = MAX_IDLE_LOADED);
+
+    std::shared_ptr<Package>       package() const;
+    std::shared_ptr<TaskInterface> interface();
+    std::shared_ptr<TaskGraph>     task_graph();
+    std::shared_ptr<TaskRouter>    task_router();
+
+    void pin(bool on);
+    bool loaded();
+    void evict();
+
+    //! load every piece on a background thread
+    //! NOTE: the package digest and the materialization of the resource dir dominate the cost, both are guarded by the
+    //! package lock and the resource cache, so the ui only waits if it asks for the same piece meanwhile
+    void prefetch();
+
+protected:
+    UmaProperty(std::shared_ptr<Package> package);
+
+    void touch();
+
+private:
+    std::recursive_mutex                  lock_;
+    std::shared_ptr<Package>              package_;
+    std::shared_ptr<TaskInterface>        interface_;
+    std::shared_ptr<TaskGraph>            task_graph_;
+    std::shared_ptr<TaskRouter>           task_router_;
+    bool                                  pinned_;
+    std::chrono::steady_clock::time_point last_used_;
 };
 
 struct UmaInstance {
@@ -59,7 +86,6 @@ struct UmaInstance {
     QString                          comment;
     QColor                           marker_color;
     QString                          device;
-    QString                          cache_key;
     std::shared_ptr<UmaProperty>     uma_prop;
     std::shared_ptr<MaaProperty>     maa_prop;
     std::shared_ptr<MessageProducer> message_producer;
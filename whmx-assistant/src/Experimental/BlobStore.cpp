@@ -0,0 +1,77 @@
+/* Copyright 2024 周上行Ryer
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "BlobStore.h"
+#include "ProjectDirs.h"
+#include "Digest.h"
+
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QUuid>
+#include <gsl/gsl>
+#include <filesystem>
+#include <system_error>
+
+namespace Experimental {
+
+QDir BlobStore::root() {
+    auto dir = ProjectDirs::app_data();
+    dir.mkpath("blobs");
+    const bool ok = dir.cd("blobs");
+    Ensures(ok);
+    return dir;
+}
+
+QString BlobStore::blob_path(const QString &digest) {
+    Expects(digest.size() > 2);
+    //! NOTE: fan out by the leading byte to keep directories small
+    return root().absoluteFilePath(QString("%1/%2").arg(digest.left(2)).arg(digest));
+}
+
+bool BlobStore::ingest(const QString &source, const QString &digest) {
+    const auto path = blob_path(digest);
+    if (QFileInfo::exists(path)) { return true; }
+
+    const QFileInfo blob_info(path);
+    blob_info.dir().mkpath(".");
+
+    //! NOTE: copy into a staging file first, so that a blob is either complete or absent
+    const auto staging = QString("%1.%2").arg(path).arg(QUuid::createUuid().toString(QUuid::Id128));
+    if (!QFile::copy(source, staging)) { return false; }
+    if (DigestEngine::hash_file(staging) != digest) {
+        QFile::remove(staging);
+        return false;
+    }
+    if (!QFile::rename(staging, path)) {
+        QFile::remove(staging);
+        return QFileInfo::exists(path);
+    }
+    return true;
+}
+
+bool BlobStore::materialize(const QString &source, const QString &digest, const QString &target) {
+    if (!ingest(source, digest)) { return QFile::copy(source, target); }
+
+    const std::filesystem::path blob(blob_path(digest).toStdWString());
+    const std::filesystem::path link(target.toStdWString());
+
+    std::error_code ec;
+    std::filesystem::create_hard_link(blob, link, ec);
+    if (!ec) { return true; }
+
+    return QFile::copy(blob_path(digest), target);
+}
+
+} // namespace Experimental
@@ -0,0 +1,41 @@
+/* Copyright 2024 周上行Ryer
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include <QtCore/QDir>
+#include <QtCore/QString>
+
+namespace Experimental {
+
+//! content-addressed store of package files, keyed by the sha256 entries of package.sha
+//! NOTE: a file is copied into the store once on first ingest, every later copy of the same content is a hardlink to
+//! the blob, so materialized files must be treated as read-only
+//! NOTE: the content is verified against the digest on first ingest, so a stale package.sha never puts the wrong blob
+//! under a digest; such files are copied as is instead
+class BlobStore {
+public:
+    static QDir root();
+
+    //! place the content of source at target, backed by the blob of the given digest
+    //! NOTE: falls back to a plain copy when the filesystem does not support hardlinks, e.g. across volumes
+    static bool materialize(const QString &source, const QString &digest, const QString &target);
+
+protected:
+    static QString blob_path(const QString &digest);
+    static bool    ingest(const QString &source, const QString &digest);
+};
+
+} // namespace Experimental
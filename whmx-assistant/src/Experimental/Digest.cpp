@@ -0,0 +1,146 @@
+/* Copyright 2024 周上行Ryer
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "Digest.h"
+
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDateTime>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QHash>
+#include <gsl/gsl>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace Experimental {
+
+struct IndexEntry {
+    qint64  size;
+    qint64  mtime;
+    QString sha;
+};
+
+//! index entry is formatted as "<sha> <size> <mtime> <path>", the path may contain spaces
+static QHash<QString, IndexEntry> load_index(const QString &index_file) {
+    QHash<QString, IndexEntry> index;
+    QFile                      file(index_file);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) { return index; }
+    for (const auto &line : QString::fromUtf8(file.readAll()).split('\n', Qt::SkipEmptyParts)) {
+        const auto fields = line.split(' ');
+        if (fields.size() < 4) { continue; }
+        bool       size_ok  = false;
+        bool       mtime_ok = false;
+        const auto size     = fields[1].toLongLong(&size_ok);
+        const auto mtime    = fields[2].toLongLong(&mtime_ok);
+        if (!size_ok || !mtime_ok) { continue; }
+        index.insert(fields.mid(3).join(' '), IndexEntry{size, mtime, fields[0]});
+    }
+    return index;
+}
+
+static void save_index(const QString &index_file, const QHash<QString, IndexEntry> &index) {
+    QFile file(index_file);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate)) { return; }
+    QStringList entries;
+    for (auto it = index.begin(); it != index.end(); ++it) {
+        entries.append(QString("%1 %2 %3 %4").arg(it->sha).arg(it->size).arg(it->mtime).arg(it.key()));
+    }
+    file.write(entries.join("\n").toUtf8());
+}
+
+QString DigestEngine::hash_file(const QString &file_path) {
+    QFile file(file_path);
+    if (!file.open(QIODevice::ReadOnly)) { return QString(); }
+
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    QByteArray         chunk(CHUNK_SIZE, Qt::Uninitialized);
+    while (true) {
+        const auto size = file.read(chunk.data(), chunk.size());
+        if (size < 0) { return QString(); }
+        if (size == 0) { break; }
+        hash.addData(QByteArrayView(chunk.constData(), size));
+    }
+    return hash.result().toHex();
+}
+
+QList<QPair<QString, QString>>
+    DigestEngine::digest_tree(const QDir &root, const QSet<QString> &excludes, const QString &index_file) {
+    struct Job {
+        QString item;
+        QString file_path;
+        qint64  size;
+        qint64  mtime;
+        QString sha;
+    };
+
+    std::vector<Job> jobs;
+    {
+        QList<QDir> stack;
+        stack.append(root);
+        while (!stack.empty()) {
+            const auto dir = stack.takeLast();
+            for (const auto &entry : dir.entryList(QDir::Dirs | QDir::NoDotAndDotDot)) {
+                stack.append(QDir(dir.absoluteFilePath(entry)));
+            }
+            for (const auto &entry : dir.entryInfoList(QDir::Files)) {
+                const auto file_path = entry.absoluteFilePath();
+                const auto item      = root.relativeFilePath(file_path);
+                if (excludes.contains(item)) { continue; }
+                jobs.push_back(Job{item, file_path, entry.size(), entry.lastModified().toMSecsSinceEpoch(), QString()});
+            }
+        }
+    }
+
+    const auto         index = load_index(index_file);
+    std::vector<Job *> pending;
+    for (auto &job : jobs) {
+        const auto it = index.find(job.item);
+        if (it != index.end() && it->size == job.size && it->mtime == job.mtime) {
+            job.sha = it->sha;
+        } else {
+            pending.push_back(&job);
+        }
+    }
+
+    //! NOTE: files are hashed independently, so workers simply pull the next pending file until none is left
+    std::atomic_size_t next = 0;
+
+    const auto worker = [&pending, &next] {
+        for (size_t i = next++; i < pending.size(); i = next++) { pending[i]->sha = hash_file(pending[i]->file_path); }
+    };
+    const size_t total_workers =
+        std::min<size_t>(pending.size(), std::max<unsigned>(std::thread::hardware_concurrency(), 1));
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < total_workers; ++i) { workers.emplace_back(worker); }
+    if (total_workers > 0) { worker(); }
+    for (auto &thread : workers) { thread.join(); }
+
+    QList<QPair<QString, QString>> sha_list;
+    QHash<QString, IndexEntry>     new_index;
+    for (const auto &job : jobs) {
+        Expects(!job.sha.isEmpty());
+        sha_list.append({job.item, job.sha});
+        new_index.insert(job.item, IndexEntry{job.size, job.mtime, job.sha});
+    }
+    std::sort(sha_list.begin(), sha_list.end());
+
+    if (!pending.empty() || new_index.size() != index.size()) { save_index(index_file, new_index); }
+
+    return sha_list;
+}
+
+} // namespace Experimental
@@ -0,0 +1,43 @@
+/* Copyright 2024 周上行Ryer
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include <QtCore/QDir>
+#include <QtCore/QList>
+#include <QtCore/QPair>
+#include <QtCore/QSet>
+#include <QtCore/QString>
+
+namespace Experimental {
+
+//! sha256 digest of package trees
+//! NOTE: files are hashed in fixed-size chunks on all cores, and a side index of (path, size, mtime) -> sha lets a
+//! re-digest skip every file which has not changed since the last run
+class DigestEngine {
+public:
+    static constexpr qint64 CHUNK_SIZE = 1 << 20;
+
+    //! hex sha256 of the file, empty if the file could not be read
+    static QString hash_file(const QString &file_path);
+
+    //! digest every file under root except the excluded relative paths, sorted by the relative path
+    //! NOTE: index_file is read before and rewritten after the digest, a missing or broken index only costs a full
+    //! rehash
+    static QList<QPair<QString, QString>>
+        digest_tree(const QDir &root, const QSet<QString> &excludes, const QString &index_file);
+};
+
+} // namespace Experimental
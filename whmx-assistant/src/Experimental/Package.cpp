@@ -14,6 +14,7 @@
 */
 
 #include "Package.h"
+#include "Digest.h"
 
 #include <QtCore/QDir>
 #include <QtCore/QCryptographicHash>
@@ -30,28 +31,35 @@ std::shared_ptr<Package> Package::create(const QString &package_dir) {
 }
 
 void Package::set_location(const QString &package_dir) {
+    std::scoped_lock lock(digest_lock_, info_lock_);
     Expects(!package_dir.isEmpty());
     if (package_dir_ == package_dir) { return; }
+    info_loaded_ = false;
     opt_info_.reset();
     opt_digest_.reset();
     package_dir_ = package_dir;
 }
 
 QString Package::location() const {
+    std::lock_guard lock(info_lock_);
     Expects(!package_dir_.isEmpty());
     return package_dir_;
 }
 
 bool Package::valid() const {
+    std::lock_guard lock(info_lock_);
+    if (!info_loaded_) { std::ignore = load_info(); }
     return opt_info_.has_value();
 }
 
 std::reference_wrapper<const PackageInfo> Package::info() const {
+    std::lock_guard lock(info_lock_);
     Ensures(valid());
     return opt_info_.value();
 }
 
 bool Package::digest_available() const {
+    std::lock_guard lock(digest_lock_);
     if (!valid()) { return false; }
     if (opt_digest_.has_value()) { return true; }
 
@@ -61,6 +69,7 @@ bool Package::digest_available() const {
 }
 
 QString Package::digest() {
+    std::lock_guard lock(digest_lock_);
     Expects(digest_available());
     if (!opt_digest_.has_value()) {
         const QDir package_dir(package_dir_);
@@ -73,42 +82,62 @@ QString Package::digest() {
 }
 
 void Package::ensure_sha_generated() {
+    std::lock_guard lock(digest_lock_);
     Expects(valid());
 
     const QDir package_dir(package_dir_);
 
-    if (!package_dir.exists(DIGEST_FILE)) {
-        QList<QPair<QString, QString>> sha_list;
-        QList<QDir>                    stack;
-        stack.append(package_dir);
-        while (!stack.empty()) {
-            const auto dir = stack.takeLast();
-            for (const auto &entry : dir.entryList(QDir::Dirs | QDir::NoDotAndDotDot)) {
-                stack.append(QDir(dir.absoluteFilePath(entry)));
-            }
-            for (const auto &entry : dir.entryList(QDir::Files)) {
-                const auto file_path = dir.absoluteFilePath(entry);
-                const auto item      = package_dir.relativeFilePath(file_path);
-                if (item == INFO_FILE) { continue; }
-                QFile file(file_path);
-                Expects(file.open(QIODevice::ReadOnly));
-                const auto sha = QCryptographicHash::hash(file.readAll(), QCryptographicHash::Sha256).toHex();
-                sha_list.append({item, sha});
-            }
-        }
-        std::sort(sha_list.begin(), sha_list.end());
-        QFile sha_file(package_dir.absoluteFilePath(DIGEST_FILE));
-        Expects(sha_file.open(QIODevice::WriteOnly | QIODevice::Text));
-        QStringList entries;
-        for (const auto &[item, sha] : sha_list) { entries.append(sha + ' ' + item); }
-        sha_file.write(entries.join("\n").toUtf8());
-    }
+    //! NOTE: the digest is verified on every call instead of only when package.sha is missing, an updated package must
+    //! not keep the digest of its previous content
+    if (write_sha()) { opt_digest_.reset(); }
 
     const QFileInfo file_info(package_dir.absoluteFilePath(DIGEST_FILE));
     Ensures(file_info.exists() && file_info.isFile() && file_info.isReadable());
 }
 
-bool Package::load_info() {
+bool Package::write_sha() {
+    std::lock_guard lock(digest_lock_);
+    const QDir          package_dir(package_dir_);
+    const QSet<QString> excludes{INFO_FILE, DIGEST_FILE, DIGEST_INDEX_FILE};
+
+    const auto sha_list = DigestEngine::digest_tree(package_dir, excludes, package_dir.absoluteFilePath(DIGEST_INDEX_FILE));
+
+    QStringList entries;
+    for (const auto &[item, sha] : sha_list) { entries.append(sha + ' ' + item); }
+    const auto content = entries.join("\n").toUtf8();
+
+    QFile sha_file(package_dir.absoluteFilePath(DIGEST_FILE));
+    if (sha_file.open(QIODevice::ReadOnly | QIODevice::Text) && sha_file.readAll() == content) { return false; }
+    sha_file.close();
+
+    Expects(sha_file.open(QIODevice::WriteOnly | QIODevice::Text));
+    sha_file.write(content);
+    return true;
+}
+
+QMap<QString, QString> Package::file_digests() {
+    std::lock_guard lock(digest_lock_);
+    ensure_sha_generated();
+
+    const QDir package_dir(package_dir_);
+    QFile      file(package_dir.absoluteFilePath(DIGEST_FILE));
+    Ensures(file.open(QIODevice::ReadOnly | QIODevice::Text));
+
+    QMap<QString, QString> digests;
+    for (const auto &line : QString::fromUtf8(file.readAll()).split('\n', Qt::SkipEmptyParts)) {
+        //! NOTE: entry is formatted as "<sha> <path>", the path may contain spaces
+        const int sep = line.indexOf(' ');
+        if (sep <= 0) { continue; }
+        digests.insert(line.mid(sep + 1), line.left(sep));
+    }
+    return digests;
+}
+
+bool Package::load_info() const {
+    std::lock_guard lock(info_lock_);
+    info_loaded_ = true;
+    opt_info_.reset();
+
     const QDir dir(package_dir_);
     if (!dir.exists(INFO_FILE)) { return false; }
 
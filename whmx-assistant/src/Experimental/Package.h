@@ -17,8 +17,10 @@
 
 #include <QtCore/QString>
 #include <QtCore/QList>
+#include <QtCore/QMap>
 #include <QtCore/QUrl>
 #include <gsl/gsl>
+#include <mutex>
 
 namespace Experimental {
 
@@ -49,10 +51,13 @@ struct PackageInfo {
     }
 };
 
+//! NOTE: a package is shared between the ui and the prefetch of uma properties; the info and the digest are guarded by
+//! separate locks, so that querying the info never waits on a package being digested
 class Package {
 public:
-    static inline const char *INFO_FILE   = "package.json";
-    static inline const char *DIGEST_FILE = "package.sha";
+    static inline const char *INFO_FILE         = "package.json";
+    static inline const char *DIGEST_FILE       = "package.sha";
+    static inline const char *DIGEST_INDEX_FILE = "package.sha.idx";
 
 public:
     static std::shared_ptr<Package> create(const QString &package_dir);
@@ -63,16 +68,27 @@ public:
     auto    info() const -> std::reference_wrapper<const PackageInfo>;
     bool    digest_available() const;
     QString digest();
+    //! (re)digest the package, package.sha is rewritten only when the content has changed
+    //! NOTE: unchanged files are skipped through the digest index, so a call on a verified package costs a stat per file
     void    ensure_sha_generated();
-    bool    load_info();
+    bool    load_info() const;
+
+    //! sha256 of each file in the package, keyed by the path relative to the package dir
+    QMap<QString, QString> file_digests();
 
 protected:
     Package() = default;
 
+    //! returns true if package.sha has been (re)written
+    bool write_sha();
+
 private:
-    QString                    package_dir_;
-    std::optional<PackageInfo> opt_info_;
-    std::optional<QString>     opt_digest_;
+    mutable std::recursive_mutex       info_lock_;
+    mutable std::recursive_mutex       digest_lock_;
+    QString                            package_dir_;
+    mutable bool                       info_loaded_ = false; //<! info is loaded lazily on first query
+    mutable std::optional<PackageInfo> opt_info_;
+    std::optional<QString>             opt_digest_;
 };
 
 } // namespace Experimental
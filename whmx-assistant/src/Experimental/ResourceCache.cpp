@@ -0,0 +1,149 @@
+/* Copyright 2024 周上行Ryer
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "ResourceCache.h"
+#include "ProjectDirs.h"
+#include "BlobStore.h"
+
+#include <QtCore/QFile>
+#include <QtCore/QMap>
+#include <QtCore/QRegularExpression>
+#include <QtCore/QUuid>
+#include <gsl/gsl>
+#include <cmath>
+#include <mutex>
+
+namespace Experimental {
+
+static std::mutex                                  RESOURCE_CACHE_LOCK;
+static std::mutex                                  MATERIALIZE_LOCK; //<! serializes the ui and the prefetch on the same digest
+static QMap<QString, std::weak_ptr<maa::Resource>> RESOURCE_CACHE;
+
+//! place the package file at target through the blob store, files missing from the digest list are copied as is
+static bool materialize_file(
+    const QDir &package_dir, const QMap<QString, QString> &digests, const QString &source, const QString &target) {
+    if (const auto digest = digests.value(package_dir.relativeFilePath(source)); !digest.isEmpty()) {
+        return BlobStore::materialize(source, digest, target);
+    } else {
+        return QFile::copy(source, target);
+    }
+}
+
+static bool materialize_folder(
+    const QDir &package_dir, const QMap<QString, QString> &digests, const QString &src, const QString &dst) {
+    const QDir dir(src);
+    if (!dir.exists()) { return true; }
+
+    if (!QDir().mkpath(dst)) { return false; }
+    for (const auto &d : dir.entryList(QDir::Dirs | QDir::NoDotAndDotDot)) {
+        if (!materialize_folder(package_dir, digests, src + QDir::separator() + d, dst + QDir::separator() + d)) {
+            return false;
+        }
+    }
+    for (const auto &f : dir.entryList(QDir::Files)) {
+        if (!materialize_file(package_dir, digests, src + QDir::separator() + f, dst + QDir::separator() + f)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::optional<QDir> ResourceCache::resource_dir(Package &package) {
+    static std::once_flag LEGACY_CLEANUP_ONCE;
+    std::call_once(LEGACY_CLEANUP_ONCE, &ResourceCache::remove_legacy_cache_dirs);
+
+    std::lock_guard lock(MATERIALIZE_LOCK);
+    package.ensure_sha_generated();
+    const auto digest = package.digest();
+
+    auto root = ProjectDirs::app_data();
+    root.mkpath("resources");
+    const bool ok = root.cd("resources");
+    Ensures(ok);
+
+    if (!root.exists(digest)) {
+        //! NOTE: materialize into a staging dir first, so that an interrupted copy never leaves a broken entry behind
+        const auto staging = QString("%1.%2").arg(digest).arg(QUuid::createUuid().toString(QUuid::Id128));
+        root.mkdir(staging);
+        const bool done = materialize(package, QDir(root.absoluteFilePath(staging)));
+        if (!done || !root.rename(staging, digest)) { QDir(root.absoluteFilePath(staging)).removeRecursively(); }
+        if (!done) { return std::nullopt; }
+    }
+
+    Ensures(root.exists(digest));
+    return QDir(root.absoluteFilePath(digest));
+}
+
+std::shared_ptr<maa::Resource> ResourceCache::acquire(const std::shared_ptr<Package> &package) {
+    const auto dir = resource_dir(*package);
+    if (!dir.has_value()) { return nullptr; }
+    const auto digest = package->digest();
+
+    std::lock_guard lock(RESOURCE_CACHE_LOCK);
+    RESOURCE_CACHE.removeIf([](const auto &entry) {
+        return entry.value().expired();
+    });
+    if (auto res = RESOURCE_CACHE.value(digest).lock()) { return res; }
+
+    auto res = maa::Resource::make();
+    res->post_path(dir->absolutePath().toStdString());
+    RESOURCE_CACHE.insert(digest, res);
+    return res;
+}
+
+void ResourceCache::remove_legacy_cache_dirs() {
+    //! NOTE: instances used to copy the package into app_data/<cache_key>, where the key is a lowercase uuid without
+    //! braces; nothing reads those dirs any more
+    const auto               root = ProjectDirs::app_data();
+    const QRegularExpression re(R"(^[0-9a-f]{32}$)");
+    for (const auto &entry : root.entryList(QDir::Dirs | QDir::NoDotAndDotDot)) {
+        if (!re.match(entry).hasMatch()) { continue; }
+        QDir(root.absoluteFilePath(entry)).removeRecursively();
+    }
+}
+
+bool ResourceCache::materialize(Package &package, const QDir &cache_dir) {
+    //! NOTE: files are hardlinked from the blob store, so identical files are stored once across package versions
+    const QDir package_dir(package.location());
+    const auto digests = package.file_digests();
+
+    for (const auto &folder : {"image", "model", "extras"}) {
+        const auto src = package_dir.absoluteFilePath(folder);
+        if (!materialize_folder(package_dir, digests, src, cache_dir.absoluteFilePath(folder))) { return false; }
+    }
+
+    QStringList pipeline_files;
+    {
+        QList<QDir> stack;
+        stack.append(package_dir.absoluteFilePath("pipeline"));
+        while (!stack.empty()) {
+            const auto dir = stack.takeLast();
+            for (const auto &entry : dir.entryList(QDir::Dirs | QDir::NoDotAndDotDot)) {
+                stack.append(QDir(dir.absoluteFilePath(entry)));
+            }
+            for (const auto &entry : dir.entryList(QDir::Files)) { pipeline_files.append(dir.absoluteFilePath(entry)); }
+        }
+    }
+    if (!cache_dir.mkpath("pipeline")) { return false; }
+    const QDir pipeline_dir(cache_dir.absoluteFilePath("pipeline"));
+    const int  nr_width = ceil(log10(std::max<int>(1, pipeline_files.size())));
+    for (int i = 0; i < pipeline_files.size(); ++i) {
+        const auto name = QString::number(i).rightJustified(nr_width, QChar('0')) + ".json";
+        if (!materialize_file(package_dir, digests, pipeline_files[i], pipeline_dir.absoluteFilePath(name))) { return false; }
+    }
+    return true;
+}
+
+} // namespace Experimental
@@ -0,0 +1,46 @@
+/* Copyright 2024 周上行Ryer
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include "Package.h"
+
+#include <MaaPP/MaaPP.hpp>
+#include <QtCore/QDir>
+#include <memory>
+#include <optional>
+
+namespace Experimental {
+
+//! shares loaded resources between instances of the same package
+//! NOTE: entries are keyed by the package digest, a resource lives as long as one of the instances holds it, and its
+//! on-disk data is materialized once per digest instead of once per instance
+class ResourceCache {
+public:
+    //! directory holding the resource data of the package, materialized on first use, std::nullopt if it failed
+    static std::optional<QDir> resource_dir(Package &package);
+
+    //! hand out the resource of the package, a new resource is created and starts loading when none is alive
+    //! NOTE: returns nullptr if the resource data could not be materialized
+    static std::shared_ptr<maa::Resource> acquire(const std::shared_ptr<Package> &package);
+
+protected:
+    static bool materialize(Package &package, const QDir &cache_dir);
+
+    //! remove the per-instance cache dirs of the layout before the resource cache, run once per process
+    static void remove_legacy_cache_dirs();
+};
+
+} // namespace Experimental
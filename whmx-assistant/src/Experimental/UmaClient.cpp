@@ -16,6 +16,7 @@
 #include "UmaClient.h"
 #include "UmaWorkbench.h"
 #include "ProjectDirs.h"
+#include "ResourceCache.h"
 #include "../App.h"
 #include "../Platform.h"
 #include "../UI/Settings.h"
@@ -140,65 +141,38 @@ void UmaClient::handle_on_request_new_uma_instance() {
     instance->marker_color = QColor(42, 109, 197);
     uma_instances_.insert(instance->instance_id, instance);
     emit on_add_uma_instance(instance->instance_id);
+
+    //! NOTE: a freshly created instance is most likely the next one to be opened
+    instance->uma_prop->prefetch();
+}
+
+void UmaClient::handle_on_remove_uma_instance(const QString &id) {
+    const auto instance = uma_instances_.take(id);
+    if (!instance) { return; }
+    //! NOTE: the workbench may still hold the instance, its pin has to be released here for the pieces to be evicted
+    instance->uma_prop->pin(false);
+    UmaProperty::trim();
 }
 
 void UmaClient::activate_uma_instance(const QString &id) {
     Expects(uma_instances_.contains(id));
     const auto instance = uma_instances_.find(id).value();
-    if (instance->cache_key.isEmpty()) { instance->cache_key = QUuid().createUuid().toString(QUuid::Id128).toLower(); }
-    instance->maa_prop         = std::make_shared<MaaProperty>();
-    instance->message_producer = std::make_shared<MessageProducer>();
 
-    auto root = ProjectDirs::app_data();
-    if (const auto &cache_key = instance->cache_key; !root.exists(cache_key)) {
-        root.mkdir(cache_key);
-        const QDir package_dir(instance->uma_prop->package->location());
-        const QDir cache_dir(root.absoluteFilePath(cache_key));
-        copy_folder(package_dir.absoluteFilePath("image"), cache_dir.absoluteFilePath("image"));
-        copy_folder(package_dir.absoluteFilePath("model"), cache_dir.absoluteFilePath("model"));
-        copy_folder(package_dir.absoluteFilePath("extras"), cache_dir.absoluteFilePath("extras"));
-        QStringList pipeline_files;
-        {
-            QList<QDir> stack;
-            stack.append(package_dir.absoluteFilePath("pipeline"));
-            while (!stack.empty()) {
-                const auto dir = stack.takeLast();
-                for (const auto &entry : dir.entryList(QDir::Dirs | QDir::NoDotAndDotDot)) {
-                    stack.append(QDir(dir.absoluteFilePath(entry)));
-                }
-                for (const auto &entry : dir.entryList(QDir::Files)) { pipeline_files.append(dir.absoluteFilePath(entry)); }
-            }
-        }
-        cache_dir.mkpath("pipeline");
-        const QDir pipeline_dir(cache_dir.absoluteFilePath("pipeline"));
-        const int  nr_width = ceil(log10(std::max<int>(1, pipeline_files.size())));
-        for (int i = 0; i < pipeline_files.size(); ++i) {
-            const auto name = QString::number(i).rightJustified(nr_width, QChar('0')) + ".json";
-            QFile::copy(pipeline_files[i], pipeline_dir.absoluteFilePath(name));
-        }
+    //! NOTE: instances of the same package share both the loaded resource and its on-disk data
+    auto res = ResourceCache::acquire(instance->uma_prop->package());
+    if (!res) {
+        Notification::error(gApp->window_cref(), "UMA", "资源包数据准备失败，请检查磁盘空间与资源包完整性");
+        return;
     }
 
-    const QDir package_dir(instance->uma_prop->package->location());
-    const QDir dir(root.absoluteFilePath(instance->cache_key));
-    const QDir pipeline_dir(dir.absoluteFilePath("pipeline"));
-
-    auto &uma_prop = instance->uma_prop;
-    auto &maa_prop = instance->maa_prop;
+    instance->maa_prop         = std::make_shared<MaaProperty>();
+    instance->message_producer = std::make_shared<MessageProducer>();
+    instance->maa_prop->res    = res;
 
-    uma_prop->task_graph = std::make_shared<TaskGraph>();
-    for (const auto &entry : pipeline_dir.entryList(QDir::Files)) {
-        uma_prop->task_graph->merge_pipeline(pipeline_dir.absoluteFilePath(entry));
-    }
-    uma_prop->task_router = TaskRouter::create(uma_prop->task_graph, uma_prop->interface->prop_context);
-    {
-        QFile file(package_dir.absoluteFilePath("router.json"));
-        Expects(file.open(QIODevice::ReadOnly));
-        const auto opt_json = json::parse(file.readAll());
-        Expects(opt_json);
-        const auto &json = opt_json.value();
-        Expects(json.is_object());
-        uma_prop->task_router->reload(json.as_object());
-    }
+    //! NOTE: an active instance keeps its pieces loaded, the idle ones give way to it
+    instance->uma_prop->pin(true);
+    std::ignore = instance->uma_prop->task_router();
+    UmaProperty::trim();
 
     auto       workbench  = new UmaWorkbench(instance);
     const auto short_name = instance->name.left(2);
@@ -261,7 +235,7 @@ gsl::strict_not_null<Card *> UmaClient::make_card_for_uma(const QString &id) {
     card->set_brief(instance->comment.isEmpty() ? "哎呀呀，我好像……并没有被备注呢。" : instance->comment);
     card->set_pin_color(instance->marker_color);
 
-    if (const auto icon_url = instance->uma_prop->package->info().get().icon_url; !icon_url.isEmpty()) {
+    if (const auto icon_url = instance->uma_prop->package()->info().get().icon_url; !icon_url.isEmpty()) {
         if (QPixmap pix(icon_url); !pix.isNull()) {
             card->set_card_pixmap(std::move(pix));
         } else {
@@ -294,7 +268,6 @@ void UmaClient::scan_and_reload_packages() {
     const auto root = ProjectDirs::create_or_get("packages");
     for (const auto dir : root.entryList(QDir::Dirs | QDir::NoDotAndDotDot | QDir::NoSymLinks)) {
         auto package = Package::create(root.absoluteFilePath(dir));
-        std::ignore  = package->load_info();
         available_packages_.append(package);
     }
 }
@@ -422,6 +395,7 @@ void UmaClient::setup() {
 
     //! setup connection
     connect(this, &UmaClient::on_request_new_uma_instance, this, &UmaClient::handle_on_request_new_uma_instance);
+    connect(this, &UmaClient::on_remove_uma_instance, this, &UmaClient::handle_on_remove_uma_instance);
 
     connect(ui_title_bar_, &TitleBar::on_request_minimize, event, &AppEvent::on_minimize);
     connect(ui_title_bar_, &TitleBar::on_request_maximize, event, &AppEvent::on_maximize);
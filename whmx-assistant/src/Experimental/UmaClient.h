@@ -45,6 +45,7 @@ signals:
 
 protected slots:
     void handle_on_request_new_uma_instance();
+    void handle_on_remove_uma_instance(const QString &id);
 
     void activate_uma_instance(const QString &id);
     void show_uma_card_context_menu(const QString &id, const QPoint &pos);
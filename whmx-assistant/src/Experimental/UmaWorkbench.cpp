@@ -51,13 +51,19 @@ UmaWorkbench::UmaWorkbench(gsl::not_null<std::shared_ptr<UmaInstance>> instance)
     setup();
 }
 
+UmaWorkbench::~UmaWorkbench() {
+    //! NOTE: the instance is no longer active once its workbench is gone, let its pieces be evicted with the idle ones
+    instance_->uma_prop->pin(false);
+    UmaProperty::trim();
+}
+
 void UmaWorkbench::setup() {
     auto task_view = new TaskView;
     task_view->setFixedWidth(240);
     {
         auto                   model = new TaskModel(task_view);
         QMap<QString, QString> keys;
-        for (const auto &[task_id, meta] : instance_->uma_prop->interface->tasks.asKeyValueRange()) {
+        for (const auto &[task_id, meta] : instance_->uma_prop->interface()->tasks.asKeyValueRange()) {
             if (meta.opt_category.has_value()) {
                 const auto category = meta.opt_category.value();
                 if (!keys.contains(category)) {
@@ -29,6 +29,7 @@ protected slots:
 
 public:
     UmaWorkbench(gsl::not_null<std::shared_ptr<UmaInstance>> instance);
+    ~UmaWorkbench() override;
 
 protected:
     void setup();
@@ -0,0 +1,219 @@
+/* Copyright 2024 周上行Ryer
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "FrameStream.h"
+#include "DeviceSession.h"
+#include "Logger.h"
+#include "Trace.h"
+#include "Metrics.h"
+
+#include <QtCore/QDebug>
+#include <algorithm>
+
+using namespace maa;
+
+using Clock = std::chrono::steady_clock;
+
+//! stream of the device which the context is running on
+static std::shared_ptr<FrameStream> stream_of(const SyncContextHandle &context) {
+    if (auto session = DeviceSession::of(context)) { return session->frame_stream(); }
+    return nullptr;
+}
+
+std::shared_ptr<FrameStream> FrameStream::create(std::shared_ptr<Controller> ctrl) {
+    return std::shared_ptr<FrameStream>(new FrameStream(ctrl));
+}
+
+coro::Promise<Frame> FrameStream::capture_after(SyncContextHandle context, uint64_t frame_id) {
+    if (auto stream = stream_of(context)) {
+        auto frame = co_await (frame_id == 0 ? stream->fresh_frame() : stream->next_frame_after(frame_id));
+        if (frame.image) { co_return frame; }
+    }
+
+    Frame frame{
+        .id          = frame_id + 1,
+        .captured_at = Clock::now(),
+        .image       = details::Image::make(),
+    };
+    co_await context->screencap(frame.image);
+    co_return frame;
+}
+
+coro::Promise<Frame> FrameStream::capture_recent(SyncContextHandle context, std::chrono::milliseconds max_age) {
+    if (auto stream = stream_of(context)) {
+        auto frame = co_await stream->recent_frame(max_age);
+        if (frame.image) { co_return frame; }
+    }
+    co_return co_await capture_after(context, 0);
+}
+
+FrameStream::FrameStream(std::shared_ptr<Controller> ctrl)
+    : ctrl_(ctrl)
+    , stopped_(false)
+    , active_until_(Clock::now())
+    , last_request_at_(Clock::now())
+    , request_interval_(IDLE_TIMEOUT)
+    , capture_latency_(Clock::duration::zero())
+    , unread_(false)
+    , next_id_(1) {
+    capture_thread_ = std::thread(&FrameStream::capture_loop, this);
+}
+
+FrameStream::~FrameStream() {
+    stop();
+}
+
+void FrameStream::stop() {
+    std::vector<Waiter> pending;
+    {
+        std::lock_guard lock(lock_);
+        stopped_ = true;
+        pending.swap(waiters_);
+    }
+    cond_.notify_all();
+    if (capture_thread_.joinable()) { capture_thread_.join(); }
+
+    //! NOTE: an invalid frame tells the consumer to fallback to its own screencap
+    for (const auto &waiter : pending) { waiter.promise.resolve(Frame{}); }
+}
+
+std::optional<Frame> FrameStream::latest() {
+    std::optional<Frame> frame;
+    {
+        std::lock_guard lock(lock_);
+        note_request();
+        frame = latest_;
+    }
+    cond_.notify_one();
+    return frame;
+}
+
+coro::Promise<Frame> FrameStream::next_frame_after(uint64_t frame_id) {
+    return wait_for_frame(frame_id, Clock::time_point::min());
+}
+
+coro::Promise<Frame> FrameStream::fresh_frame() {
+    return wait_for_frame(0, Clock::now());
+}
+
+coro::Promise<Frame> FrameStream::recent_frame(std::chrono::milliseconds max_age) {
+    return wait_for_frame(0, Clock::now() - max_age);
+}
+
+void FrameStream::note_request() {
+    const auto now      = Clock::now();
+    const auto interval = std::min<Clock::duration>(now - last_request_at_, IDLE_TIMEOUT);
+    request_interval_   = (request_interval_ + interval) / 2;
+    last_request_at_    = now;
+    active_until_       = std::max(active_until_, now + IDLE_TIMEOUT);
+    unread_             = false;
+}
+
+coro::Promise<Frame> FrameStream::wait_for_frame(uint64_t after_id, Clock::time_point since) {
+    coro::Promise<Frame> promise;
+    std::optional<Frame> ready;
+    {
+        std::lock_guard lock(lock_);
+        note_request();
+        if (false) {
+        } else if (stopped_) {
+            ready = Frame{};
+        } else if (latest_.has_value() && latest_->id > after_id && latest_->captured_at >= since) {
+            ready = latest_;
+        } else {
+            waiters_.push_back(Waiter{after_id, since, promise});
+        }
+    }
+    cond_.notify_one();
+    if (ready.has_value()) { promise.resolve(ready.value()); }
+    return promise;
+}
+
+void FrameStream::capture_loop() {
+    auto &latency  = Metrics::Registry::instance().histogram("whmx_screencap_duration_seconds");
+    auto &failures = Metrics::Registry::instance().counter("whmx_screencap_failures_total");
+
+    while (true) {
+        {
+            std::unique_lock lock(lock_);
+            while (!stopped_ && waiters_.empty()) {
+                //! NOTE: a prefetched frame nobody has read yet means the consumer is slower than the capture, wait
+                //! for its next request instead of taking another one
+                const auto now = Clock::now();
+                if (unread_ || now >= active_until_) {
+                    cond_.wait(lock);
+                    continue;
+                }
+                const auto prefetch_at = last_request_at_ + request_interval_ - capture_latency_;
+                if (now >= prefetch_at) { break; }
+                cond_.wait_until(lock, std::min(prefetch_at, active_until_));
+            }
+            if (stopped_) { break; }
+        }
+
+        TRACE_SCOPE("io", "screencap");
+        const auto captured_at = Clock::now();
+        const auto status      = ctrl_->post_screencap()->wait().sync_wait();
+        const auto elapsed     = Clock::now() - captured_at;
+        latency.record(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+        {
+            std::lock_guard lock(lock_);
+            capture_latency_ = (capture_latency_ + elapsed) / 2;
+        }
+        if (status != MaaStatus_Success) {
+            failures.inc();
+            LOG_WARN() << "frame stream: screencap failed with status" << status;
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            continue;
+        }
+
+        auto image = acquire_buffer();
+        ctrl_->image(image);
+        publish(Frame{0, captured_at, image});
+    }
+}
+
+void FrameStream::publish(Frame frame) {
+    std::vector<Waiter> ready;
+    {
+        std::lock_guard lock(lock_);
+        frame.id = next_id_++;
+        latest_  = frame;
+
+        const auto it = std::partition(waiters_.begin(), waiters_.end(), [&frame](const Waiter &waiter) {
+            return frame.id <= waiter.after_id || frame.captured_at < waiter.since;
+        });
+        ready.assign(std::make_move_iterator(it), std::make_move_iterator(waiters_.end()));
+        waiters_.erase(it, waiters_.end());
+        unread_ = ready.empty();
+    }
+
+    for (const auto &waiter : ready) {
+        coro::EventLoop::current()->defer([promise = waiter.promise, frame] {
+            promise.resolve(frame);
+        });
+    }
+}
+
+ImageHandle FrameStream::acquire_buffer() {
+    std::lock_guard lock(lock_);
+    for (const auto &buffer : buffers_) {
+        //! NOTE: the buffer is free once the pool holds the only reference
+        if (buffer.use_count() == 1) { return buffer; }
+    }
+    auto buffer = details::Image::make();
+    if (buffers_.size() < BUFFER_SIZE) { buffers_.push_back(buffer); }
+    return buffer;
+}
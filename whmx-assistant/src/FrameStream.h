@@ -0,0 +1,97 @@
+/* Copyright 2024 周上行Ryer
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include <MaaPP/MaaPP.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+struct Frame {
+    uint64_t                              id;          //<! monotonic frame id starting from 1, 0 means invalid
+    std::chrono::steady_clock::time_point captured_at; //<! time when the screencap request was issued
+    maa::ImageHandle                      image;       //<! read-only once published
+};
+
+//! background capture stage which keeps pulling frames from the controller while someone is polling the screen
+//! NOTE: while idle between requests the stream prefetches at most one frame per request, timed to be ready when the
+//! next request is expected, so the controller is never polled faster than the consumer reads
+//! NOTE: frames are published into a small pool of image buffers, a buffer is only reused after every consumer has
+//! dropped its reference, so a published frame never changes under the consumer
+class FrameStream {
+public:
+    static constexpr int  BUFFER_SIZE      = 3;
+    static constexpr auto IDLE_TIMEOUT     = std::chrono::seconds(3);
+    static constexpr auto RECENT_FRAME_AGE = std::chrono::milliseconds(200);
+
+    static std::shared_ptr<FrameStream> create(std::shared_ptr<maa::Controller> ctrl);
+
+    //! capture a frame newer than frame_id, frame_id 0 requires a frame captured after the call
+    //! NOTE: falls back to a blocking screencap of the context when it is not bound through a device session
+    static maa::coro::Promise<Frame> capture_after(maa::SyncContextHandle context, uint64_t frame_id);
+
+    //! capture a frame which is at most max_age old, the latest frame is taken as is when it is recent enough
+    //! NOTE: only for reads which do not follow an input of the caller, those need a frame captured after the input
+    static maa::coro::Promise<Frame>
+        capture_recent(maa::SyncContextHandle context, std::chrono::milliseconds max_age = RECENT_FRAME_AGE);
+
+    ~FrameStream();
+
+    void stop();
+
+    std::optional<Frame>      latest();
+    maa::coro::Promise<Frame> next_frame_after(uint64_t frame_id);
+    maa::coro::Promise<Frame> fresh_frame();
+    maa::coro::Promise<Frame> recent_frame(std::chrono::milliseconds max_age);
+
+protected:
+    FrameStream(std::shared_ptr<maa::Controller> ctrl);
+
+    maa::coro::Promise<Frame> wait_for_frame(uint64_t after_id, std::chrono::steady_clock::time_point since);
+
+    //! must be called with the lock held
+    void note_request();
+
+    void             capture_loop();
+    void             publish(Frame frame);
+    maa::ImageHandle acquire_buffer();
+
+private:
+    struct Waiter {
+        uint64_t                              after_id;
+        std::chrono::steady_clock::time_point since;
+        maa::coro::Promise<Frame>             promise;
+    };
+
+    std::shared_ptr<maa::Controller>      ctrl_;
+    std::mutex                            lock_;
+    std::condition_variable               cond_;
+    bool                                  stopped_;
+    std::chrono::steady_clock::time_point active_until_;
+    std::chrono::steady_clock::time_point last_request_at_;
+    std::chrono::steady_clock::duration   request_interval_; //<! smoothed interval between requests
+    std::chrono::steady_clock::duration   capture_latency_;  //<! smoothed duration of a screencap
+    bool                                  unread_;           //<! the latest frame has not been handed to anyone
+    uint64_t                              next_id_;
+    std::optional<Frame>                  latest_;
+    std::vector<Waiter>                   waiters_;
+    std::vector<maa::ImageHandle>         buffers_;
+    std::thread                           capture_thread_;
+};
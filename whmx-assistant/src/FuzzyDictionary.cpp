@@ -0,0 +1,125 @@
+/* Copyright 2024 周上行Ryer
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#include "FuzzyDictionary.h"
+
+#include <algorithm>
+#include <numeric>
+
+static std::u32string decode_utf8(std::string_view text) {
+    std::u32string resp;
+    resp.reserve(text.size());
+    for (size_t i = 0; i < text.size();) {
+        const auto lead = static_cast<unsigned char>(text[i]);
+        int        size = 1;
+        char32_t   code = lead;
+        if (false) {
+        } else if (lead >= 0xf0) {
+            size = 4;
+            code = lead & 0x07;
+        } else if (lead >= 0xe0) {
+            size = 3;
+            code = lead & 0x0f;
+        } else if (lead >= 0xc0) {
+            size = 2;
+            code = lead & 0x1f;
+        }
+        //! NOTE: truncated sequences are kept byte by byte instead of being dropped
+        if (i + size > text.size()) { size = 1; }
+        for (int j = 1; j < size; ++j) { code = (code << 6) | (static_cast<unsigned char>(text[i + j]) & 0x3f); }
+        resp.push_back(size == 1 ? lead : code);
+        i += size;
+    }
+    return resp;
+}
+
+int FuzzyDictionary::default_max_distance(size_t length) {
+    return std::max<int>(1, length / 3);
+}
+
+bool FuzzyDictionary::insert(std::string_view word, int id) {
+    int node = 0;
+    for (const char32_t ch : decode_utf8(word)) {
+        auto &children = nodes_[node].children;
+        auto  it       = std::lower_bound(children.begin(), children.end(), ch, [](const auto &child, char32_t ch) {
+            return child.first < ch;
+        });
+        if (it == children.end() || it->first != ch) {
+            const int next = nodes_.size();
+            it             = children.insert(it, {ch, next});
+            nodes_.emplace_back();
+        }
+        node = it->second;
+    }
+    if (nodes_[node].word != -1) { return false; }
+    nodes_[node].word = words_.size();
+    words_.push_back({std::string(word), id});
+    return true;
+}
+
+std::optional<FuzzyDictionary::Match> FuzzyDictionary::lookup(std::string_view text, int max_distance) const {
+    const auto query = decode_utf8(text);
+    if (max_distance < 0) { max_distance = default_max_distance(query.size()); }
+
+    int best_word     = -1;
+    int best_distance = max_distance + 1;
+    int best_count    = 0;
+
+    //! NOTE: one row of the levenshtein table per trie level, a subtree is pruned once every cell of its row exceeds
+    //! the bound, the shared prefixes of the vocabulary are thus only computed once
+    std::vector<std::vector<int>> rows(1, std::vector<int>(query.size() + 1));
+    std::iota(rows[0].begin(), rows[0].end(), 0);
+
+    struct Step {
+        int      node;
+        size_t   depth;
+        char32_t ch;
+    };
+
+    std::vector<Step> pending{Step{0, 0, 0}};
+    while (!pending.empty()) {
+        const auto [node, depth, ch] = pending.back();
+        pending.pop_back();
+
+        //! NOTE: siblings are visited depth-first, so the row of the parent is still intact when a sibling is reached
+        if (depth > 0) {
+            if (rows.size() <= depth) { rows.emplace_back(query.size() + 1); }
+            const auto &prev = rows[depth - 1];
+            auto       &row  = rows[depth];
+            row[0]           = prev[0] + 1;
+            for (size_t i = 1; i <= query.size(); ++i) {
+                const int cost = query[i - 1] == ch ? 0 : 1;
+                row[i]         = std::min({prev[i] + 1, row[i - 1] + 1, prev[i - 1] + cost});
+            }
+        }
+
+        const auto &row = rows[depth];
+        if (const int word = nodes_[node].word; word != -1) {
+            if (const int distance = row.back(); distance < best_distance) {
+                best_word     = word;
+                best_distance = distance;
+                best_count    = 1;
+            } else if (distance == best_distance) {
+                ++best_count;
+            }
+        }
+        if (*std::min_element(row.begin(), row.end()) > best_distance) { continue; }
+
+        for (const auto &[next_ch, child] : nodes_[node].children) { pending.push_back(Step{child, depth + 1, next_ch}); }
+    }
+
+    if (best_word == -1 || best_count > 1) { return std::nullopt; }
+    const auto &[word, id] = words_[best_word];
+    return Match{id, word, best_distance};
+}
@@ -0,0 +1,59 @@
+/* Copyright 2024 周上行Ryer
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#pragma once
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+//! trie over a fixed vocabulary which maps noisy ocr text to the canonical word within a bounded edit distance
+//! NOTE: words are compared by unicode code points, so that a misread cjk character costs one edit instead of three
+class FuzzyDictionary {
+public:
+    struct Match {
+        int         id;
+        std::string word;     //<! canonical word in utf8
+        int         distance; //<! edit distance from the queried text
+    };
+
+    //! suggested tolerance for a word of the given length, i.e. one edit per three characters and at least one
+    static int default_max_distance(size_t length);
+
+    //! returns false if the word is already in the dictionary, the id of the former word is kept
+    bool insert(std::string_view word, int id);
+
+    //! the closest word within max_distance, std::nullopt if there is none or several words are equally close
+    //! NOTE: max_distance < 0 means default_max_distance of the queried text
+    std::optional<Match> lookup(std::string_view text, int max_distance = -1) const;
+
+    bool empty() const {
+        return words_.empty();
+    }
+
+    size_t size() const {
+        return words_.size();
+    }
+
+private:
+    struct Node {
+        std::vector<std::pair<char32_t, int>> children; //<! sorted by code point
+        int                                   word = -1;
+    };
+
+    std::vector<Node>                        nodes_{Node{}};
+    std::vector<std::pair<std::string, int>> words_;
+};
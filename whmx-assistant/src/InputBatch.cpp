@@ -0,0 +1,209 @@
+/* Copyright 2024 周上行Ryer
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "InputBatch.h"
+#include "DeviceSession.h"
+#include "Logger.h"
+#include "Trace.h"
+#include "Watchdog.h"
+
+#include <QtCore/QDebug>
+
+using namespace maa;
+
+using Clock = std::chrono::steady_clock;
+
+//! injector of the device which the context is running on
+static std::shared_ptr<InputInjector> injector_of(const SyncContextHandle &context) {
+    if (auto session = DeviceSession::of(context)) { return session->input_injector(); }
+    return nullptr;
+}
+
+//! resolves once the delay is over, the wait is left to the watchdog thread so that no worker of the event loop is held
+static coro::Promise<void> sleep_for(std::chrono::milliseconds delay) {
+    coro::Promise<void> promise;
+    const auto          ticket = Watchdog::instance().arm(delay, [promise] {
+        coro::EventLoop::current()->defer([promise] {
+            promise.resolve();
+        });
+    });
+    //! NOTE: the watchdog refuses to arm once it is stopped on shutdown, do not leave the caller hanging
+    if (ticket == 0) { promise.resolve(); }
+    return promise;
+}
+
+InputBatch &InputBatch::tap(int x, int y, int delay_after_ms) {
+    events_.push_back(InputEvent{
+        .kind        = InputEvent::Kind::Tap,
+        .x1          = x,
+        .y1          = y,
+        .x2          = x,
+        .y2          = y,
+        .duration    = 0,
+        .delay_after = std::chrono::milliseconds(delay_after_ms),
+    });
+    return *this;
+}
+
+InputBatch &InputBatch::swipe(int x1, int y1, int x2, int y2, int duration_ms, int delay_after_ms) {
+    events_.push_back(InputEvent{
+        .kind        = InputEvent::Kind::Swipe,
+        .x1          = x1,
+        .y1          = y1,
+        .x2          = x2,
+        .y2          = y2,
+        .duration    = duration_ms,
+        .delay_after = std::chrono::milliseconds(delay_after_ms),
+    });
+    return *this;
+}
+
+InputBatch &InputBatch::delay(int ms) {
+    if (events_.empty()) {
+        events_.push_back(InputEvent{
+            .kind        = InputEvent::Kind::Wait,
+            .x1          = 0,
+            .y1          = 0,
+            .x2          = 0,
+            .y2          = 0,
+            .duration    = 0,
+            .delay_after = std::chrono::milliseconds(ms),
+        });
+    } else {
+        events_.back().delay_after += std::chrono::milliseconds(ms);
+    }
+    return *this;
+}
+
+std::shared_ptr<InputInjector> InputInjector::create(std::shared_ptr<Controller> ctrl) {
+    return std::shared_ptr<InputInjector>(new InputInjector(ctrl));
+}
+
+coro::Promise<bool> InputInjector::submit(SyncContextHandle context, InputBatch batch) {
+    if (auto injector = injector_of(context)) { co_return co_await injector->post(std::move(batch)); }
+
+    for (const auto &event : batch.events()) {
+        bool done = true;
+        if (false) {
+        } else if (event.kind == InputEvent::Kind::Tap) {
+            done = co_await context->click(event.x1, event.y1);
+        } else if (event.kind == InputEvent::Kind::Swipe) {
+            done = co_await context->swipe(event.x1, event.y1, event.x2, event.y2, event.duration);
+        }
+        if (!done) { co_return false; }
+        if (event.delay_after.count() > 0) { co_await sleep_for(event.delay_after); }
+    }
+
+    co_return true;
+}
+
+InputInjector::InputInjector(std::shared_ptr<Controller> ctrl)
+    : ctrl_(ctrl)
+    , stopped_(false) {
+    inject_thread_ = std::thread(&InputInjector::inject_loop, this);
+}
+
+InputInjector::~InputInjector() {
+    stop();
+}
+
+void InputInjector::stop() {
+    std::deque<Job> pending;
+    {
+        std::lock_guard lock(lock_);
+        stopped_ = true;
+        pending.swap(jobs_);
+    }
+    cond_.notify_all();
+    if (inject_thread_.joinable()) { inject_thread_.join(); }
+
+    for (const auto &job : pending) { job.promise.resolve(false); }
+}
+
+coro::Promise<bool> InputInjector::post(InputBatch batch) {
+    coro::Promise<bool> promise;
+    bool                accepted = false;
+    {
+        std::lock_guard lock(lock_);
+        if (!stopped_) {
+            jobs_.push_back(Job{std::move(batch), promise});
+            accepted = true;
+        }
+    }
+    if (accepted) {
+        cond_.notify_one();
+    } else {
+        promise.resolve(false);
+    }
+    return promise;
+}
+
+void InputInjector::inject_loop() {
+    while (true) {
+        Job job;
+        {
+            std::unique_lock lock(lock_);
+            cond_.wait(lock, [this] {
+                return stopped_ || !jobs_.empty();
+            });
+            if (stopped_) { break; }
+            job = std::move(jobs_.front());
+            jobs_.pop_front();
+        }
+
+        const bool done = inject(job.batch);
+        coro::EventLoop::current()->defer([promise = job.promise, done] {
+            promise.resolve(done);
+        });
+    }
+}
+
+bool InputInjector::inject(const InputBatch &batch) {
+    Trace::Span span("io", "input");
+    span.attr("events", batch.events().size());
+
+    bool                                           done = true;
+    std::vector<std::shared_ptr<ControllerAction>> in_flight;
+
+    for (const auto &event : batch.events()) {
+        if (false) {
+        } else if (event.kind == InputEvent::Kind::Tap) {
+            in_flight.push_back(ctrl_->post_click(event.x1, event.y1));
+        } else if (event.kind == InputEvent::Kind::Swipe) {
+            in_flight.push_back(ctrl_->post_swipe(event.x1, event.y1, event.x2, event.y2, event.duration));
+        }
+
+        if (event.delay_after.count() == 0) { continue; }
+
+        //! NOTE: events without delay are pipelined into the controller queue, a delay is always measured from the
+        //! moment the preceding events have been injected
+        for (const auto &action : in_flight) {
+            const bool ok = action->wait().sync_wait() == MaaStatus_Success;
+            done          = done && ok;
+        }
+        in_flight.clear();
+
+        TRACE_SCOPE("io", "sleep");
+        std::this_thread::sleep_until(Clock::now() + event.delay_after);
+    }
+
+    for (const auto &action : in_flight) {
+        const bool ok = action->wait().sync_wait() == MaaStatus_Success;
+        done          = done && ok;
+    }
+
+    if (!done) { LOG_WARN() << "input injector: batch of" << batch.events().size() << "events partially failed"; }
+    return done;
+}
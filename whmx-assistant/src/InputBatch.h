@@ -0,0 +1,98 @@
+/* Copyright 2024 周上行Ryer
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include <MaaPP/MaaPP.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct InputEvent {
+    enum class Kind {
+        Tap,
+        Swipe,
+        Wait, //<! no input, only holds the delay
+    };
+
+    Kind                      kind;
+    int                       x1;
+    int                       y1;
+    int                       x2;          //<! swipe only
+    int                       y2;          //<! swipe only
+    int                       duration;    //<! swipe only, in milliseconds
+    std::chrono::milliseconds delay_after; //<! measured from the moment the event is injected
+};
+
+//! timed sequence of taps and swipes which is injected as a whole
+class InputBatch {
+public:
+    InputBatch &tap(int x, int y, int delay_after_ms = 0);
+    InputBatch &swipe(int x1, int y1, int x2, int y2, int duration_ms, int delay_after_ms = 0);
+    InputBatch &delay(int ms);
+
+    const std::vector<InputEvent> &events() const {
+        return events_;
+    }
+
+    bool empty() const {
+        return events_.empty();
+    }
+
+private:
+    std::vector<InputEvent> events_;
+};
+
+//! per-controller input stage which injects batches on its own thread
+//! NOTE: events are posted to the controller directly instead of going through the sync context, so that a batch
+//! costs a single round-trip and the delays between events do not depend on the load of the maa event loop
+class InputInjector {
+public:
+    static std::shared_ptr<InputInjector> create(std::shared_ptr<maa::Controller> ctrl);
+
+    //! inject the batch with the injector of the device session, or event by event through the context when it is not
+    //! bound through a session
+    static maa::coro::Promise<bool> submit(maa::SyncContextHandle context, InputBatch batch);
+
+    ~InputInjector();
+
+    void stop();
+
+    //! resolves to true once every event in the batch has been injected successfully
+    maa::coro::Promise<bool> post(InputBatch batch);
+
+protected:
+    InputInjector(std::shared_ptr<maa::Controller> ctrl);
+
+    void inject_loop();
+    bool inject(const InputBatch &batch);
+
+private:
+    struct Job {
+        InputBatch               batch;
+        maa::coro::Promise<bool> promise;
+    };
+
+    std::shared_ptr<maa::Controller> ctrl_;
+    std::mutex                       lock_;
+    std::condition_variable          cond_;
+    bool                             stopped_;
+    std::deque<Job>                  jobs_;
+    std::thread                      inject_thread_;
+};
@@ -0,0 +1,207 @@
+/* Copyright 2024 周上行Ryer
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "LogBackend.h"
+#include "UI/LogPanel.h"
+
+#include <QtCore/QDateTime>
+#include <spdlog/spdlog.h>
+#include <algorithm>
+
+namespace LoggerImpl {
+
+namespace {
+struct LocalRing {
+    std::shared_ptr<LogRing> ring;
+
+    ~LocalRing() {
+        if (ring) { ring->retire(); }
+    }
+};
+} // namespace
+
+//! set while the thread is draining, a record posted meanwhile comes from a sink or a message handler called by dispatch
+static thread_local bool DRAINING = false;
+
+static int64_t now_us() {
+    using namespace std::chrono;
+    return duration_cast<microseconds>(system_clock::now().time_since_epoch()).count();
+}
+
+static spdlog::level::level_enum spdlog_level_of(QtMsgType type) {
+    switch (type) {
+        case QtDebugMsg: {
+            return spdlog::level::trace;
+        } break;
+        case QtInfoMsg: {
+            return spdlog::level::info;
+        } break;
+        case QtWarningMsg: {
+            return spdlog::level::warn;
+        } break;
+        case QtCriticalMsg:
+            [[fallthrough]];
+        case QtFatalMsg: {
+            return spdlog::level::err;
+        } break;
+    }
+    return spdlog::level::info;
+}
+
+AsyncLogBackend &AsyncLogBackend::instance() {
+    static AsyncLogBackend instance;
+    return instance;
+}
+
+AsyncLogBackend::AsyncLogBackend()
+    : wakeup_(false)
+    , stopped_(false)
+    , dropped_(0) {
+    drain_thread_ = std::thread(&AsyncLogBackend::drain_loop, this);
+}
+
+AsyncLogBackend::~AsyncLogBackend() {
+    stop();
+}
+
+void AsyncLogBackend::post(LogRecord record) {
+    //! NOTE: a record posted from inside a drain is written directly, draining again for it would lock the non-recursive
+    //! drain lock which the thread already holds
+    if (DRAINING || stopped_.load(std::memory_order_acquire)) {
+        //! NOTE: both sinks are thread-safe, no need to lock here which may re-enter from a message raised in dispatch
+        std::vector<LogRecord> batch;
+        batch.push_back(std::move(record));
+        dispatch(batch);
+        return;
+    }
+
+    const bool urgent = record.type == QtWarningMsg || record.type == QtCriticalMsg || record.type == QtFatalMsg;
+    auto       ring   = local_ring();
+
+    //! NOTE: verbose records are dropped when the ring is full so that a flood of trace messages never blocks the
+    //! recognizers, while warnings and errors are kept at the cost of draining on the calling thread
+    while (!ring->push(std::move(record))) {
+        if (!urgent) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        drain();
+    }
+
+    if (urgent) {
+        {
+            std::lock_guard lock(wake_lock_);
+            wakeup_ = true;
+        }
+        wake_cond_.notify_one();
+    }
+}
+
+void AsyncLogBackend::flush() {
+    drain();
+    if (auto logger = spdlog::default_logger_raw()) { logger->flush(); }
+}
+
+void AsyncLogBackend::stop() {
+    {
+        std::lock_guard lock(wake_lock_);
+        if (stopped_.load(std::memory_order_acquire)) { return; }
+        stopped_.store(true, std::memory_order_release);
+    }
+    wake_cond_.notify_all();
+    if (drain_thread_.joinable()) { drain_thread_.join(); }
+    flush();
+}
+
+LogRing *AsyncLogBackend::local_ring() {
+    thread_local LocalRing local;
+    if (!local.ring) {
+        local.ring = std::make_shared<LogRing>();
+        std::lock_guard lock(rings_lock_);
+        rings_.push_back(local.ring);
+    }
+    return local.ring.get();
+}
+
+void AsyncLogBackend::drain_loop() {
+    while (true) {
+        {
+            std::unique_lock lock(wake_lock_);
+            wake_cond_.wait_for(lock, DRAIN_INTERVAL, [this] {
+                return wakeup_ || stopped_.load(std::memory_order_acquire);
+            });
+            if (stopped_.load(std::memory_order_acquire)) { break; }
+            wakeup_ = false;
+        }
+        drain();
+    }
+}
+
+void AsyncLogBackend::drain() {
+    //! NOTE: e.g. flush from a message handler called by dispatch, whatever is pending is left to the outer drain
+    if (DRAINING) { return; }
+
+    std::lock_guard        lock(drain_lock_);
+    std::vector<LogRecord> batch;
+    {
+        std::lock_guard rings_lock(rings_lock_);
+        std::erase_if(rings_, [&batch](const std::shared_ptr<LogRing> &ring) {
+            //! NOTE: check the retirement ahead of draining, every record of a retired ring is visible by then
+            const bool retired = ring->retired();
+            LogRecord  record;
+            while (ring->pop(record)) { batch.push_back(std::move(record)); }
+            return retired && ring->empty();
+        });
+    }
+
+    if (const auto dropped = dropped_.exchange(0, std::memory_order_relaxed); dropped > 0) {
+        batch.push_back(LogRecord{
+            .timestamp_us = now_us(),
+            .type         = QtWarningMsg,
+            .channel      = LogChannel::Runtime,
+            .text         = QString("logger: %1 verbose messages dropped due to full buffer").arg(dropped),
+        });
+    }
+
+    if (batch.empty()) { return; }
+
+    //! NOTE: records from different threads are only ordered within a single drain
+    std::stable_sort(batch.begin(), batch.end(), [](const LogRecord &lhs, const LogRecord &rhs) {
+        return lhs.timestamp_us < rhs.timestamp_us;
+    });
+    DRAINING = true;
+    dispatch(batch);
+    DRAINING = false;
+}
+
+void AsyncLogBackend::dispatch(std::vector<LogRecord> &batch) {
+    for (auto &record : batch) {
+        if (false) {
+        } else if (record.channel == LogChannel::Runtime) {
+            auto logger = spdlog::default_logger_raw();
+            if (!logger) { continue; }
+            const auto timestamp = spdlog::log_clock::time_point(std::chrono::microseconds(record.timestamp_us));
+            const auto text      = record.text.toUtf8();
+            const auto level     = spdlog_level_of(record.type);
+            logger->log(timestamp, spdlog::source_loc{}, level, spdlog::string_view_t(text.data(), text.size()));
+        } else if (record.channel == LogChannel::Workstation) {
+            const auto log_time = QDateTime::fromMSecsSinceEpoch(record.timestamp_us / 1000);
+            const auto info     = QString("%1 %2\n").arg(log_time.toString("yyyy-MM-dd hh:mm:ss.zzz")).arg(record.text);
+            UI::LogPanel::log_to_global_panels(info);
+        }
+    }
+}
+
+} // namespace LoggerImpl
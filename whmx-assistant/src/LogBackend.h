@@ -0,0 +1,85 @@
+/* Copyright 2024 周上行Ryer
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include "SpscRing.h"
+
+#include <QtCore/QString>
+#include <QtCore/QtLogging>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace LoggerImpl {
+
+enum class LogChannel {
+    Runtime,     //<! runtime log file through spdlog
+    Workstation, //<! log panels on the ui
+};
+
+struct LogRecord {
+    int64_t    timestamp_us; //<! microseconds since epoch, formatted on the drain thread
+    QtMsgType  type;
+    LogChannel channel;
+    QString    text; //<! message text with the patched marker stripped
+};
+
+using LogRing = SpscRing<LogRecord, 1024>;
+
+//! asynchronous logging backend which takes the formatting and the sink io off the logging threads
+//! NOTE: producers only write into their own ring and never take a lock on the hot path, the drain thread merges the
+//! rings by timestamp and forwards the records to spdlog and the log panels
+class AsyncLogBackend {
+public:
+    static constexpr auto DRAIN_INTERVAL = std::chrono::milliseconds(50);
+
+    static AsyncLogBackend &instance();
+
+    ~AsyncLogBackend();
+
+    void post(LogRecord record);
+
+    //! drain every pending record synchronously and flush the runtime logger
+    void flush();
+
+    //! stop the drain thread, records posted afterwards are dispatched on the calling thread
+    void stop();
+
+protected:
+    AsyncLogBackend();
+
+    LogRing *local_ring();
+    void     drain_loop();
+    void     drain();
+    void     dispatch(std::vector<LogRecord> &batch);
+
+private:
+    std::mutex                            drain_lock_; //<! serializes the consumers of the rings
+    std::mutex                            rings_lock_;
+    std::vector<std::shared_ptr<LogRing>> rings_;
+    std::mutex                            wake_lock_;
+    std::condition_variable               wake_cond_;
+    bool                                  wakeup_;
+    std::atomic_bool                      stopped_;
+    std::atomic_size_t                    dropped_;
+    std::thread                           drain_thread_;
+};
+
+} // namespace LoggerImpl
@@ -14,13 +14,13 @@
 */
 
 #include "Logger.h"
-#include "UI/LogPanel.h"
+#include "LogBackend.h"
 
-#include <QtCore/QDateTime>
+#include <QtCore/QCoreApplication>
 #include <QtCore/QDir>
-#include <spdlog/spdlog.h>
-#include <mutex>
 #include <array>
+#include <chrono>
+#include <fcntl.h>
 #include <io.h>
 
 namespace fs = std::filesystem;
@@ -31,45 +31,41 @@ Q_LOGGING_CATEGORY(Workstation, "Workstation")
 } // namespace LoggerImpl
 
 void global_logger_handler(QtMsgType type, const QMessageLogContext &context, const QString &msg) {
-    static std::mutex LOGGER_LOCK;
-    std::lock_guard   lock(LOGGER_LOCK);
+    using namespace LoggerImpl;
+    using namespace std::chrono;
 
-    const auto log_time = QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm:ss.zzz");
+    //! NOTE: only capture the timestamp as integer here, formatting is deferred to the drain thread
+    const auto log_time = duration_cast<microseconds>(system_clock::now().time_since_epoch()).count();
 
-    std::optional<QString> opt_patched_info;
-    QString                msg_text;
+    QString msg_text;
     if (const char data_link_escape_ctrl = '\x10'; msg.startsWith(data_link_escape_ctrl)) {
         const char start_of_text_ctrl = '\x02';
         Q_ASSERT(msg.count(start_of_text_ctrl) == 1);
-        const int text_start = msg.indexOf(start_of_text_ctrl) + 1;
-        msg_text             = msg.mid(text_start);
-        opt_patched_info     = msg.mid(1, text_start - 2);
+        msg_text = msg.mid(msg.indexOf(start_of_text_ctrl) + 1);
     } else {
         msg_text = msg;
     }
 
+    LogChannel channel;
     if (false) {
     } else if (strcmp(context.category, "AppRuntime") == 0) {
-        switch (type) {
-            case QtDebugMsg: {
-                spdlog::trace(msg_text.toUtf8().toStdString());
-            } break;
-            case QtInfoMsg: {
-                spdlog::info(msg_text.toUtf8().toStdString());
-            } break;
-            case QtWarningMsg: {
-                spdlog::warn(msg_text.toUtf8().toStdString());
-            } break;
-            case QtCriticalMsg:
-                [[fallthrough]];
-            case QtFatalMsg: {
-                spdlog::error(msg_text.toUtf8().toStdString());
-            } break;
-        }
+        channel = LogChannel::Runtime;
     } else if (strcmp(context.category, "Workstation") == 0) {
-        const auto info = QString("%1 %2\n").arg(log_time).arg(msg_text);
-        for (auto logger : UI::LogPanel::global_logger_panels()) { UI::LogPanel::log(logger, info); }
+        channel = LogChannel::Workstation;
+    } else {
+        return;
     }
+
+    auto &backend = AsyncLogBackend::instance();
+    backend.post(LogRecord{
+        .timestamp_us = log_time,
+        .type         = type,
+        .channel      = channel,
+        .text         = std::move(msg_text),
+    });
+
+    //! NOTE: qt aborts right after a fatal message, make sure it reaches the log file
+    if (type == QtFatalMsg) { backend.flush(); }
 }
 
 namespace {
@@ -98,7 +94,10 @@ void GlobalLoggerProxy::setup() {
 }
 
 GlobalLoggerProxy::GlobalLoggerProxy()
-    : injected_(false) {
+    : injected_(false)
+    , stopped_(false)
+    , next_seq_(0)
+    , next_post_seq_(0) {
     redirections_[0].file = stdout;
     redirections_[1].file = stderr;
 }
@@ -106,57 +105,103 @@ GlobalLoggerProxy::GlobalLoggerProxy()
 void GlobalLoggerProxy::inject_logger_proxy() {
     if (injected_) { return; }
 
-    //! FIXME: the current implementation do not guarantee the order of the log messages, which may cause some confusion.
-
-    //! FIXME: on the windows platform, the redirection is not working correctly to the output from the dll. BUT, ehh, sometimes
-    //! it may work well, but I don't know why it works well or why it doesn't.
+    //! FIXME: on the windows platform, the redirection is not working correctly to the output from the dll which links
+    //! to another crt, since only the file descriptors of our own crt are replaced.
 
-    for (auto &[file, file_track, saved_fd, redirection] : redirections_) {
-        redirection = std::make_unique<QTemporaryFile>();
-        redirection->setAutoRemove(true);
-        redirection->open();
+    for (auto &[file, saved_fd, read_fd, reader] : redirections_) {
+        std::array<int, 2> fds{};
+        if (_pipe(fds.data(), PIPE_SIZE, _O_BINARY | _O_NOINHERIT) != 0) {
+            qWarning() << "failed to create pipe for stdio redirection";
+            saved_fd = -1;
+            read_fd  = -1;
+            continue;
+        }
 
-        saved_fd = dup(fileno(file));
-        freopen(redirection->fileName().toLocal8Bit().data(), "a", file);
+        //! NOTE: gui application may start without a valid stdio, bind it to a file descriptor first
+        if (_fileno(file) < 0) { freopen("NUL", "w", file); }
 
-        file_track = std::make_unique<QFile>(redirection->fileName());
-        file_track->open(QIODevice::ReadOnly | QIODevice::Text);
+        fflush(file);
+        saved_fd = _dup(_fileno(file));
+        _dup2(fds[1], _fileno(file));
+        _close(fds[1]);
 
-        //! move the cursor to the end of the file to skip the old messages
-        file_track->seek(file_track->size());
+        //! NOTE: pipes are fully buffered by the crt, disable the buffering so that lines are forwarded once printed
+        setvbuf(file, nullptr, _IONBF, 0);
 
-        watcher_.addPath(redirection->fileName());
-        connect(&watcher_, &QFileSystemWatcher::fileChanged, this, [this, file_track = file_track.get()](const QString &path) {
-            if (path != file_track->fileName()) { return; }
-            if (const auto text = file_track->readAll(); !text.isEmpty()) { post_hooked_logger_message(file_track->readAll()); }
-        });
+        read_fd = fds[0];
+        reader  = std::thread(&GlobalLoggerProxy::read_loop, this, read_fd);
     }
 
     qInstallMessageHandler(global_logger_handler);
 
+    //! NOTE: stop the drain thread while the runtime logger is still alive, later messages are logged synchronously
+    connect(qApp, &QCoreApplication::aboutToQuit, this, [] {
+        LoggerImpl::AsyncLogBackend::instance().stop();
+    });
+
     injected_ = true;
 }
 
 void GlobalLoggerProxy::cleanup() {
     if (!injected_) { return; }
 
-    disconnect(&watcher_, &QFileSystemWatcher::fileChanged, this, nullptr);
+    stopped_ = true;
 
-    for (auto &[file, file_track, saved_fd, redirection] : redirections_) {
-        watcher_.removePath(redirection->fileName());
-        file_track.reset();
+    for (auto &[file, saved_fd, read_fd, reader] : redirections_) {
         //! FIXME: restore stdout by dup2 would cause the assertion failure for the gui application in debug mode
 #if 0
         dup2(saved_fd, fileno(file));
 #endif
-        redirection.reset();
+        //! NOTE: the write end is still held by the stdio, the reader never sees the eof, so just let it go
+        if (reader.joinable()) { reader.detach(); }
     }
 
     qInstallMessageHandler(nullptr);
+    LoggerImpl::AsyncLogBackend::instance().stop();
 
     injected_ = false;
 }
 
-void GlobalLoggerProxy::post_hooked_logger_message(QString message) {
-    LOG_INFO().noquote() << message;
+void GlobalLoggerProxy::read_loop(int read_fd) {
+    std::array<char, 4096> chunk;
+    QByteArray             pending;
+
+    while (!stopped_) {
+        const int n = _read(read_fd, chunk.data(), static_cast<unsigned int>(chunk.size()));
+        if (n <= 0) { break; }
+        pending.append(chunk.data(), n);
+
+        qsizetype start = 0;
+        for (auto eol = pending.indexOf('\n'); eol != -1; eol = pending.indexOf('\n', start)) {
+            forward_line(pending.mid(start, eol - start));
+            start = eol + 1;
+        }
+        pending.remove(0, start);
+
+        if (pending.size() >= MAX_LINE_LENGTH) { forward_line(std::exchange(pending, QByteArray())); }
+    }
+
+    if (!pending.isEmpty()) { forward_line(pending); }
+}
+
+void GlobalLoggerProxy::forward_line(QByteArray line) {
+    if (stopped_) { return; }
+    if (line.endsWith('\r')) { line.chop(1); }
+    const quint64 seq = next_seq_.fetch_add(1);
+    QMetaObject::invokeMethod(
+        this,
+        "post_hooked_logger_message",
+        Qt::QueuedConnection,
+        Q_ARG(quint64, seq),
+        Q_ARG(QString, QString::fromLocal8Bit(line)));
+}
+
+void GlobalLoggerProxy::post_hooked_logger_message(quint64 seq, QString message) {
+    //! NOTE: lines of both streams are numbered in the order they are read, but the queued posts from the two reader
+    //! threads may still interleave, so hold the early ones back until the sequence is continuous
+    pending_lines_.insert(seq, message);
+    while (!pending_lines_.isEmpty() && pending_lines_.firstKey() == next_post_seq_) {
+        LOG_INFO().noquote() << pending_lines_.take(next_post_seq_);
+        ++next_post_seq_;
+    }
 }
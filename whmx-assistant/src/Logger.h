@@ -18,13 +18,14 @@
 #include "MacroHelper.h"
 
 #include <QtCore/QtLogging>
-#include <QtCore/QTemporaryFile>
 #include <QtCore/QFile>
-#include <QtCore/QFileSystemWatcher>
 #include <QtCore/QTimer>
+#include <QtCore/QMap>
 #include <stdio.h>
 #include <memory>
 #include <array>
+#include <atomic>
+#include <thread>
 #include <QtCore/QLoggingCategory>
 
 #define PATCHED_MESSAGE_LOGGER_COMMON(category, level, patched_info)                                             \
@@ -119,7 +120,7 @@ public:
     }
 
     ~PatchedDebug() {
-        steal_debug_stream(*this)->buffer.prepend(QString("\x10%1\x02").arg(patched_info_));
+        steal_debug_stream(*this)->buffer.prepend(QChar(0x10) + patched_info_ + QChar(0x02));
         QDebug::~QDebug();
     }
 
@@ -159,6 +160,9 @@ class GlobalLoggerProxy final : public QObject {
     Q_OBJECT
 
 public:
+    static constexpr unsigned int PIPE_SIZE       = 64 * 1024;
+    static constexpr qsizetype    MAX_LINE_LENGTH = 16 * 1024; //<! overlong lines are forwarded in pieces
+
     static std::shared_ptr<GlobalLoggerProxy> instance();
 
     static void setup();
@@ -169,18 +173,24 @@ private:
     void inject_logger_proxy();
     void cleanup();
 
+    void read_loop(int read_fd);
+    void forward_line(QByteArray line);
+
 private slots:
-    void post_hooked_logger_message(QString message);
+    void post_hooked_logger_message(quint64 seq, QString message);
 
 private:
     struct Redirection {
-        FILE                           *file;
-        std::unique_ptr<QFile>          file_track;
-        int                             saved_fd;
-        std::unique_ptr<QTemporaryFile> redirection;
+        FILE       *file;
+        int         saved_fd;
+        int         read_fd;
+        std::thread reader;
     };
 
     bool                       injected_;
-    QFileSystemWatcher         watcher_;
+    std::atomic_bool           stopped_;
+    std::atomic_uint64_t       next_seq_;      //<! sequence number of the next captured line
+    quint64                    next_post_seq_; //<! sequence number of the next line to log, owned by the proxy thread
+    QMap<quint64, QString>     pending_lines_; //<! lines arrived ahead of their predecessors
     std::array<Redirection, 2> redirections_;
 };
@@ -0,0 +1,212 @@
+/* Copyright 2024 周上行Ryer
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "Metrics.h"
+#include "Logger.h"
+
+#include <QtCore/QFile>
+#include <QtCore/QDebug>
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <format>
+#include <mutex>
+
+namespace Metrics {
+
+//! bucket boundaries of the exported histograms, in microseconds
+static constexpr std::array<int64_t, 20> EXPORTED_BOUNDS{
+    1'000,
+    2'500,
+    5'000,
+    10'000,
+    25'000,
+    50'000,
+    100'000,
+    250'000,
+    500'000,
+    1'000'000,
+    2'500'000,
+    5'000'000,
+    10'000'000,
+    30'000'000,
+    60'000'000,
+    120'000'000,
+    300'000'000,
+    600'000'000,
+    1'800'000'000,
+    3'600'000'000,
+};
+
+static std::string escape_label_value(const std::string &value) {
+    std::string resp;
+    resp.reserve(value.size());
+    for (const char ch : value) {
+        if (false) {
+        } else if (ch == '\\') {
+            resp += "\\\\";
+        } else if (ch == '"') {
+            resp += "\\\"";
+        } else if (ch == '\n') {
+            resp += "\\n";
+        } else {
+            resp += ch;
+        }
+    }
+    return resp;
+}
+
+static std::string with_braces(const std::string &labels) {
+    return labels.empty() ? std::string() : "{" + labels + "}";
+}
+
+static std::string seconds_of(uint64_t us) {
+    return std::format("{}", us / 1e6);
+}
+
+int64_t Histogram::Snapshot::quantile(double q) const {
+    if (count == 0) { return 0; }
+    const auto target = std::max<uint64_t>(static_cast<uint64_t>(std::ceil(q * count)), 1);
+    uint64_t   acc    = 0;
+    for (size_t i = 0; i < NUM_BUCKETS; ++i) {
+        acc += counts[i];
+        if (acc >= target) { return bucket_upper_bound(i); }
+    }
+    return bucket_upper_bound(NUM_BUCKETS - 1);
+}
+
+uint64_t Histogram::Snapshot::count_below(int64_t bound) const {
+    uint64_t acc = 0;
+    for (size_t i = 0; i < NUM_BUCKETS && bucket_upper_bound(i) <= bound; ++i) { acc += counts[i]; }
+    return acc;
+}
+
+size_t Histogram::bucket_of(int64_t value) {
+    if (value < SUB_BUCKETS) { return static_cast<size_t>(std::max<int64_t>(value, 0)); }
+    const int exponent = std::bit_width(static_cast<uint64_t>(value)) - 1;
+    if (exponent >= MAX_EXPONENT) { return NUM_BUCKETS - 1; }
+    const int  shift = exponent - SUB_BUCKET_BITS;
+    const auto sub   = static_cast<size_t>((value >> shift) - SUB_BUCKETS);
+    return SUB_BUCKETS + shift * SUB_BUCKETS + sub;
+}
+
+int64_t Histogram::bucket_upper_bound(size_t index) {
+    if (index < SUB_BUCKETS) { return static_cast<int64_t>(index); }
+    const auto shift = (index - SUB_BUCKETS) / SUB_BUCKETS;
+    const auto sub   = (index - SUB_BUCKETS) % SUB_BUCKETS;
+    return (static_cast<int64_t>(SUB_BUCKETS + sub + 1) << shift) - 1;
+}
+
+void Histogram::record(int64_t value) {
+    value = std::max<int64_t>(value, 0);
+    counts_[bucket_of(value)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(static_cast<uint64_t>(value), std::memory_order_relaxed);
+}
+
+Histogram::Snapshot Histogram::snapshot() const {
+    Snapshot snapshot;
+    for (size_t i = 0; i < NUM_BUCKETS; ++i) { snapshot.counts[i] = counts_[i].load(std::memory_order_relaxed); }
+    snapshot.sum = sum_.load(std::memory_order_relaxed);
+    //! NOTE: buckets and count are not updated atomically as a whole, derive the count from the buckets to keep the
+    //! exported histogram consistent
+    snapshot.count = 0;
+    for (const auto count : snapshot.counts) { snapshot.count += count; }
+    return snapshot;
+}
+
+Registry &Registry::instance() {
+    static Registry instance;
+    return instance;
+}
+
+Counter &Registry::counter(const std::string &name, const Labels &labels) {
+    const auto key = render_labels(labels);
+    {
+        std::shared_lock lock(lock_);
+        if (const auto it = counters_.find(name); it != counters_.end()) {
+            if (const auto series = it->second.find(key); series != it->second.end()) { return *series->second; }
+        }
+    }
+    std::unique_lock lock(lock_);
+    auto            &series = counters_[name][key];
+    if (!series) { series = std::make_unique<Counter>(); }
+    return *series;
+}
+
+Histogram &Registry::histogram(const std::string &name, const Labels &labels) {
+    const auto key = render_labels(labels);
+    {
+        std::shared_lock lock(lock_);
+        if (const auto it = histograms_.find(name); it != histograms_.end()) {
+            if (const auto series = it->second.find(key); series != it->second.end()) { return *series->second; }
+        }
+    }
+    std::unique_lock lock(lock_);
+    auto            &series = histograms_[name][key];
+    if (!series) { series = std::make_unique<Histogram>(); }
+    return *series;
+}
+
+std::string Registry::to_prometheus() const {
+    std::shared_lock lock(lock_);
+    std::string      resp;
+
+    for (const auto &[name, family] : counters_) {
+        resp += std::format("# TYPE {} counter\n", name);
+        for (const auto &[labels, series] : family) {
+            resp += std::format("{}{} {}\n", name, with_braces(labels), series->value());
+        }
+    }
+
+    for (const auto &[name, family] : histograms_) {
+        resp += std::format("# TYPE {} histogram\n", name);
+        for (const auto &[labels, series] : family) {
+            const auto snapshot = series->snapshot();
+            const auto prefix   = labels.empty() ? std::string() : labels + ",";
+            for (const auto bound : EXPORTED_BOUNDS) {
+                const auto le = seconds_of(bound);
+                resp += std::format("{}_bucket{{{}le=\"{}\"}} {}\n", name, prefix, le, snapshot.count_below(bound));
+            }
+            resp += std::format("{}_bucket{{{}le=\"+Inf\"}} {}\n", name, prefix, snapshot.count);
+            resp += std::format("{}_sum{} {}\n", name, with_braces(labels), seconds_of(snapshot.sum));
+            resp += std::format("{}_count{} {}\n", name, with_braces(labels), snapshot.count);
+        }
+    }
+
+    return resp;
+}
+
+bool Registry::dump(const QString &path) const {
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+        LOG_WARN() << "failed to open metrics file" << path;
+        return false;
+    }
+    const auto text = to_prometheus();
+    file.write(text.data(), static_cast<qint64>(text.size()));
+    return true;
+}
+
+std::string Registry::render_labels(const Labels &labels) {
+    std::string resp;
+    for (const auto &[key, value] : labels) {
+        if (!resp.empty()) { resp += ","; }
+        resp += std::format("{}=\"{}\"", key, escape_label_value(value));
+    }
+    return resp;
+}
+
+} // namespace Metrics
@@ -0,0 +1,128 @@
+/* Copyright 2024 周上行Ryer
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include <QtCore/QString>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Metrics {
+
+using Labels = std::vector<std::pair<std::string, std::string>>;
+
+class Counter {
+public:
+    void inc(uint64_t delta = 1) {
+        value_.fetch_add(delta, std::memory_order_relaxed);
+    }
+
+    uint64_t value() const {
+        return value_.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic_uint64_t value_{0};
+};
+
+//! log-linear histogram in the spirit of the hdr histogram, values are bucketed with a relative error bounded by
+//! 1 / SUB_BUCKETS, recording is lock-free
+//! NOTE: values are in microseconds, which covers up to ~19 hours with MAX_EXPONENT
+class Histogram {
+public:
+    static constexpr int    SUB_BUCKET_BITS = 4;
+    static constexpr int    SUB_BUCKETS     = 1 << SUB_BUCKET_BITS;
+    static constexpr int    MAX_EXPONENT    = 36;
+    static constexpr size_t NUM_BUCKETS     = SUB_BUCKETS + (MAX_EXPONENT - SUB_BUCKET_BITS) * SUB_BUCKETS;
+
+    struct Snapshot {
+        std::array<uint64_t, NUM_BUCKETS> counts;
+        uint64_t                          count;
+        uint64_t                          sum;
+
+        //! upper bound of the bucket holding the given quantile
+        int64_t quantile(double q) const;
+
+        //! number of values not greater than bound
+        uint64_t count_below(int64_t bound) const;
+    };
+
+    static size_t  bucket_of(int64_t value);
+    static int64_t bucket_upper_bound(size_t index); //<! inclusive
+
+    void     record(int64_t value);
+    Snapshot snapshot() const;
+
+private:
+    std::array<std::atomic_uint64_t, NUM_BUCKETS> counts_{};
+    std::atomic_uint64_t                          count_{0};
+    std::atomic_uint64_t                          sum_{0};
+};
+
+//! records the elapsed time of the scope into the histogram
+class ScopedTimer {
+public:
+    explicit ScopedTimer(Histogram &histogram)
+        : histogram_(histogram)
+        , start_(std::chrono::steady_clock::now()) {}
+
+    ~ScopedTimer() {
+        const auto elapsed = std::chrono::steady_clock::now() - start_;
+        histogram_.record(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+    }
+
+    ScopedTimer(const ScopedTimer &)            = delete;
+    ScopedTimer &operator=(const ScopedTimer &) = delete;
+
+private:
+    Histogram                            &histogram_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+//! process-wide registry of metric series, a series lives as long as the process once created
+//! NOTE: looking up a series takes a shared lock, callers on hot paths with fixed labels should keep the reference
+class Registry {
+public:
+    static Registry &instance();
+
+    Counter   &counter(const std::string &name, const Labels &labels = {});
+    Histogram &histogram(const std::string &name, const Labels &labels = {});
+
+    //! render every series in the prometheus text exposition format, durations are exported in seconds
+    std::string to_prometheus() const;
+
+    //! write the prometheus text into the file, used to keep the numbers of a session after shutdown
+    bool dump(const QString &path) const;
+
+protected:
+    Registry() = default;
+
+    static std::string render_labels(const Labels &labels);
+
+private:
+    mutable std::shared_mutex                                                lock_;
+    std::map<std::string, std::map<std::string, std::unique_ptr<Counter>>>   counters_;   //<! name -> labels -> series
+    std::map<std::string, std::map<std::string, std::unique_ptr<Histogram>>> histograms_; //<! name -> labels -> series
+};
+
+} // namespace Metrics
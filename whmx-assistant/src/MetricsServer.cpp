@@ -0,0 +1,70 @@
+/* Copyright 2024 周上行Ryer
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "MetricsServer.h"
+#include "Metrics.h"
+#include "Logger.h"
+
+#include <QtNetwork/QTcpSocket>
+#include <QtCore/QDebug>
+
+bool MetricsServer::listen(quint16 port) {
+    if (server_->isListening()) { return true; }
+    if (!server_->listen(QHostAddress::LocalHost, port)) {
+        LOG_WARN() << "failed to start metrics endpoint on port" << port << ":" << server_->errorString();
+        return false;
+    }
+    LOG_INFO() << "metrics endpoint listening on" << QString("http://127.0.0.1:%1/metrics").arg(port);
+    return true;
+}
+
+void MetricsServer::handle_on_new_connection() {
+    while (auto socket = server_->nextPendingConnection()) {
+        connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+        connect(socket, &QTcpSocket::readyRead, socket, [socket] {
+            //! NOTE: only the request line matters, wait until the header is complete to avoid replying mid-request
+            if (!socket->canReadLine()) {
+                if (socket->bytesAvailable() > MAX_REQUEST_BYTES) { socket->abort(); }
+                return;
+            }
+            const auto request_line = socket->readLine().trimmed();
+            socket->readAll();
+            socket->write(make_response(request_line));
+            socket->disconnectFromHost();
+        });
+    }
+}
+
+MetricsServer::MetricsServer(QObject *parent)
+    : QObject(parent)
+    , server_(new QTcpServer(this)) {
+    connect(server_, &QTcpServer::newConnection, this, &MetricsServer::handle_on_new_connection);
+}
+
+QByteArray MetricsServer::make_response(const QByteArray &request_line) {
+    const auto parts = request_line.split(' ');
+    if (parts.size() < 2 || parts[0] != "GET" || parts[1] != "/metrics") {
+        return "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+    }
+
+    const auto body = QByteArray::fromStdString(Metrics::Registry::instance().to_prometheus());
+    QByteArray resp;
+    resp += "HTTP/1.1 200 OK\r\n";
+    resp += "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n";
+    resp += "Content-Length: " + QByteArray::number(body.size()) + "\r\n";
+    resp += "Connection: close\r\n\r\n";
+    resp += body;
+    return resp;
+}
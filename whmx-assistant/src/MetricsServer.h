@@ -0,0 +1,43 @@
+/* Copyright 2024 周上行Ryer
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include <QtCore/QObject>
+#include <QtNetwork/QTcpServer>
+
+//! minimal http endpoint on the loopback interface which serves the metrics registry in the prometheus text format
+//! NOTE: only `GET /metrics` is served, every connection is closed after a single response
+class MetricsServer : public QObject {
+    Q_OBJECT
+
+public:
+    static constexpr quint16 DEFAULT_PORT      = 9464;
+    static constexpr int     MAX_REQUEST_BYTES = 8 * 1024;
+
+    bool listen(quint16 port = DEFAULT_PORT);
+
+protected slots:
+    void handle_on_new_connection();
+
+public:
+    MetricsServer(QObject *parent = nullptr);
+
+protected:
+    static QByteArray make_response(const QByteArray &request_line);
+
+private:
+    QTcpServer *server_;
+};
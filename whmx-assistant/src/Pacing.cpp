@@ -0,0 +1,74 @@
+/* Copyright 2024 周上行Ryer
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#include "Pacing.h"
+
+namespace Pacing {
+
+using namespace maa;
+
+using Clock = std::chrono::steady_clock;
+
+static double mean_abs_diff(const cv::Mat &lhs, const cv::Mat &rhs) {
+    if (lhs.size() != rhs.size() || lhs.type() != rhs.type() || lhs.empty()) { return 0.0; }
+    return cv::norm(lhs, rhs, cv::NORM_L1) / (lhs.total() * lhs.channels());
+}
+
+cv::Mat roi_of(const Frame &frame, const MaaRect &roi) {
+    const auto   &image = frame.image;
+    const cv::Mat im(image->height(), image->width(), image->type(), image->raw_data());
+    return im.rowRange(roi.y, roi.y + roi.height).colRange(roi.x, roi.x + roi.width);
+}
+
+coro::Promise<PaceResult>
+    wait_until(SyncContextHandle context, std::function<bool(const Frame &)> pred, std::chrono::milliseconds ceiling) {
+    const auto deadline = Clock::now() + ceiling;
+
+    //! NOTE: the first frame must be captured after the call, so that it already reflects the preceding input
+    uint64_t frame_id = 0;
+    while (true) {
+        const auto frame = co_await FrameStream::capture_after(context, frame_id);
+        frame_id         = frame.id;
+        if (pred(frame)) { co_return PaceResult{true, frame}; }
+        if (Clock::now() >= deadline) { co_return PaceResult{false, frame}; }
+    }
+}
+
+coro::Promise<PaceResult> settle_after_change(
+    SyncContextHandle         context,
+    const Frame              &reference,
+    const MaaRect            &roi,
+    std::chrono::milliseconds ceiling,
+    double                    threshold) {
+    //! NOTE: the roi of the last frame is cloned since the frame buffer is recycled once the frame is dropped
+    const auto origin  = roi_of(reference, roi).clone();
+    bool       changed = false;
+    cv::Mat    last;
+
+    co_return co_await wait_until(
+        context,
+        [&](const Frame &frame) {
+            const auto current = roi_of(frame, roi);
+            const bool still   = !last.empty() && mean_abs_diff(last, current) <= threshold;
+            current.copyTo(last);
+            if (!changed) {
+                changed = mean_abs_diff(origin, current) > threshold;
+                return false;
+            }
+            return still;
+        },
+        ceiling);
+}
+
+} // namespace Pacing
@@ -0,0 +1,50 @@
+/* Copyright 2024 周上行Ryer
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#pragma once
+
+#include "FrameStream.h"
+
+#include <MaaPP/MaaPP.hpp>
+#include <opencv2/core.hpp>
+#include <chrono>
+#include <functional>
+
+//! adaptive pacing of input sequences, the screen is watched after an input and the sequence proceeds as soon as the
+//! expected visual outcome is observed, the fixed delay of the slowest device is only kept as the ceiling
+namespace Pacing {
+
+constexpr double DEFAULT_CHANGE_THRESHOLD = 4.0; //<! mean absolute difference per channel, in [0, 255]
+
+struct PaceResult {
+    bool  observed; //<! false if the ceiling is reached first
+    Frame frame;    //<! the last frame looked at, a natural reference for the next input
+};
+
+//! poll frames captured after the call until the predicate holds or the ceiling is reached
+maa::coro::Promise<PaceResult> wait_until(
+    maa::SyncContextHandle context, std::function<bool(const Frame &)> pred, std::chrono::milliseconds ceiling);
+
+//! wait until the roi differs from the reference frame and then keeps still for a frame
+maa::coro::Promise<PaceResult> settle_after_change(
+    maa::SyncContextHandle    context,
+    const Frame              &reference,
+    const MaaRect            &roi,
+    std::chrono::milliseconds ceiling,
+    double                    threshold = DEFAULT_CHANGE_THRESHOLD);
+
+//! view of the roi in the frame, the frame must be valid
+cv::Mat roi_of(const Frame &frame, const MaaRect &roi);
+
+} // namespace Pacing
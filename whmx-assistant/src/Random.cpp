@@ -0,0 +1,83 @@
+/* Copyright 2024 周上行Ryer
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#include "Random.h"
+#include "Logger.h"
+
+#include <QtCore/QDebug>
+#include <QtCore/QtGlobal>
+#include <mutex>
+#include <optional>
+#include <random>
+
+static uint64_t splitmix64(uint64_t &state) {
+    uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+    z          = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z          = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+static uint64_t rotl(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+Xoshiro256::Xoshiro256(uint64_t seed) {
+    for (auto &state : state_) { state = splitmix64(seed); }
+}
+
+Xoshiro256::result_type Xoshiro256::operator()() {
+    const uint64_t result = rotl(state_[1] * 5, 7) * 9;
+    const uint64_t t      = state_[1] << 17;
+
+    state_[2] ^= state_[0];
+    state_[3] ^= state_[1];
+    state_[1] ^= state_[2];
+    state_[0] ^= state_[3];
+    state_[2] ^= t;
+    state_[3]  = rotl(state_[3], 45);
+
+    return result;
+}
+
+namespace Random {
+
+static std::mutex              SEED_LOCK;
+static std::optional<uint64_t> SESSION_SEED;
+
+uint64_t session_seed() {
+    std::lock_guard lock(SEED_LOCK);
+    if (!SESSION_SEED.has_value()) {
+        bool       ok   = false;
+        const auto seed = qEnvironmentVariable("WHMX_RNG_SEED").toULongLong(&ok);
+        if (ok) {
+            SESSION_SEED = seed;
+        } else {
+            std::random_device device;
+            SESSION_SEED = (static_cast<uint64_t>(device()) << 32) | device();
+        }
+        LOG_INFO() << "rng session seed:" << SESSION_SEED.value();
+    }
+    return SESSION_SEED.value();
+}
+
+Xoshiro256 stream(std::string_view key, uint64_t index) {
+    //! NOTE: fnv-1a, the key must hash the same across runs and builds which std::hash does not promise
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (const unsigned char ch : key) { hash = (hash ^ ch) * 0x100000001b3ull; }
+    uint64_t state = session_seed() ^ hash;
+    state          = splitmix64(state) + index * 0x9e3779b97f4a7c15ull;
+    return Xoshiro256(splitmix64(state));
+}
+
+} // namespace Random
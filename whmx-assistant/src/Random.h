@@ -0,0 +1,54 @@
+/* Copyright 2024 周上行Ryer
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <string_view>
+
+//! xoshiro256** generator, satisfies UniformRandomBitGenerator so that it works with the std distributions
+//! NOTE: see https://prng.di.unimi.it, the state is 32 bytes and a draw is a handful of shifts and multiplies
+class Xoshiro256 {
+public:
+    using result_type = uint64_t;
+
+    explicit Xoshiro256(uint64_t seed);
+
+    static constexpr result_type min() {
+        return 0;
+    }
+
+    static constexpr result_type max() {
+        return std::numeric_limits<result_type>::max();
+    }
+
+    result_type operator()();
+
+private:
+    uint64_t state_[4];
+};
+
+//! random number service, generators are derived from the session seed and a stable key instead of from the thread
+//! NOTE: the session seed is drawn from std::random_device once and logged, it can be overridden by the WHMX_RNG_SEED
+//! environment variable to replay a session; the key names what draws, e.g. a task and the count of its former runs, so
+//! that a replay is exact no matter which pool thread the draws land on
+namespace Random {
+
+uint64_t session_seed();
+
+//! generator of the index-th stream under the key
+Xoshiro256 stream(std::string_view key, uint64_t index);
+
+} // namespace Random
@@ -18,12 +18,17 @@
 #include "../Decode.h"
 #include "../ReferenceDataSet.h"
 #include "../Algorithm.h"
+#include "../ResultStore.h"
+#include "../FuzzyDictionary.h"
+#include "TileMatch.h"
 
 #include <map>
+#include <mutex>
+#include <tuple>
+#include <utility>
 #include <limits>
 #include <array>
 #include <vector>
-#include <set>
 #include <opencv2/imgproc.hpp>
 #include <QtCore/QDebug>
 #include <QtCore/QElapsedTimer>
@@ -61,45 +66,96 @@ static json::object make_ocr_params(const MaaRect &roi = MaaRect{0, 0, 0, 0}, co
     };
 }
 
-static void grade_face_tilt_correct(const cv::Mat &src, cv::Mat &dst, GradeFaceCorner corner) {
+struct GradeFaceRemap {
+    cv::Size size;       //<! size of the corrected face
+    cv::Mat  map_xy;     //<! fixed-point source coordinates, CV_16SC2
+    cv::Mat  map_interp; //<! interpolation table indices, CV_16UC1
+};
+
+//! forward affine transform from the face crop to the corrected face
+static cv::Mat grade_face_transform(const cv::Size &face_size, GradeFaceCorner corner, cv::Size &size_out) {
+    const int w = face_size.width;
+    const int h = face_size.height;
     switch (corner) {
         case GradeFaceCorner::Top: {
-            cv::resize(src, dst, cv::Size(src.cols / 2, src.rows));
-            const cv::Point2i center{dst.cols / 2, dst.rows / 2};
-            const auto        transform = cv::getRotationMatrix2D(center, -45.0, 1.41421);
-            cv::warpAffine(dst, dst, transform, dst.size());
-        } break;
+            //! NOTE: squash the face to half width and then rotate it about the center of the squashed face
+            size_out = cv::Size(w / 2, h);
+
+            const double      sx = static_cast<double>(size_out.width) / w;
+            const cv::Point2i center{size_out.width / 2, size_out.height / 2};
+            cv::Mat           squash(cv::Matx33d(sx, 0, 0.5 * sx - 0.5, 0, 1, 0, 0, 0, 1));
+            cv::Mat           rotate = cv::Mat::eye(3, 3, CV_64F);
+            cv::getRotationMatrix2D(center, -45.0, 1.41421).copyTo(rotate.rowRange(0, 2));
+            return cv::Mat(rotate * squash).rowRange(0, 2).clone();
+        }
         case GradeFaceCorner::Left: {
+            size_out = cv::Size(w, h / 3 * 2);
             std::array<cv::Point2f, 3> src_points{
                 cv::Point2f(0, 0),
-                cv::Point2f(src.cols, src.rows / 3),
-                cv::Point2f(0, src.rows / 3 * 2),
+                cv::Point2f(w, h / 3),
+                cv::Point2f(0, h / 3 * 2),
             };
             std::array<cv::Point2f, 3> dst_points{
                 cv::Point2f(0, 0),
-                cv::Point2f(src.cols, 0),
-                cv::Point2f(0, src.rows / 3 * 2),
+                cv::Point2f(w, 0),
+                cv::Point2f(0, h / 3 * 2),
             };
-            auto transform = cv::getAffineTransform(src_points.data(), dst_points.data());
-            cv::warpAffine(src, dst, transform, src.size());
-            dst = dst.rowRange(0, dst.rows / 3 * 2);
-        } break;
+            return cv::getAffineTransform(src_points.data(), dst_points.data());
+        }
         case GradeFaceCorner::Right: {
+            size_out = cv::Size(w, h / 3 * 2);
             std::array<cv::Point2f, 3> src_points{
-                cv::Point2f(src.cols, 0),
-                cv::Point2f(src.cols, src.rows / 3 * 2),
-                cv::Point2f(0, src.rows / 3),
+                cv::Point2f(w, 0),
+                cv::Point2f(w, h / 3 * 2),
+                cv::Point2f(0, h / 3),
             };
             std::array<cv::Point2f, 3> dst_points{
-                cv::Point2f(src.cols, 0),
-                cv::Point2f(src.cols, src.rows / 3 * 2),
+                cv::Point2f(w, 0),
+                cv::Point2f(w, h / 3 * 2),
                 cv::Point2f(0, 0),
             };
-            auto transform = cv::getAffineTransform(src_points.data(), dst_points.data());
-            cv::warpAffine(src, dst, transform, src.size());
-            dst = dst.rowRange(0, dst.rows / 3 * 2);
-        } break;
+            return cv::getAffineTransform(src_points.data(), dst_points.data());
+        }
+    }
+    std::unreachable();
+}
+
+static GradeFaceRemap make_grade_face_remap(const cv::Size &face_size, GradeFaceCorner corner) {
+    GradeFaceRemap remap;
+    cv::Mat        inverse;
+    cv::invertAffineTransform(grade_face_transform(face_size, corner, remap.size), inverse);
+
+    const cv::Matx23d m(inverse);
+    cv::Mat           map_x(remap.size, CV_32FC1);
+    cv::Mat           map_y(remap.size, CV_32FC1);
+    for (int y = 0; y < remap.size.height; ++y) {
+        auto *row_x = map_x.ptr<float>(y);
+        auto *row_y = map_y.ptr<float>(y);
+        for (int x = 0; x < remap.size.width; ++x) {
+            row_x[x] = static_cast<float>(m(0, 0) * x + m(0, 1) * y + m(0, 2));
+            row_y[x] = static_cast<float>(m(1, 0) * x + m(1, 1) * y + m(1, 2));
+        }
     }
+    cv::convertMaps(map_x, map_y, remap.map_xy, remap.map_interp, CV_16SC2);
+    return remap;
+}
+
+//! NOTE: the face geometry only depends on the resolution, so the lookup maps are built once per face size and corner
+static const GradeFaceRemap &grade_face_remap(const cv::Size &face_size, GradeFaceCorner corner) {
+    static std::mutex                                                      REMAP_LOCK;
+    static std::map<std::tuple<int, int, GradeFaceCorner>, GradeFaceRemap> REMAP_CACHE;
+
+    std::lock_guard lock(REMAP_LOCK);
+    const auto      key = std::make_tuple(face_size.width, face_size.height, corner);
+    if (auto it = REMAP_CACHE.find(key); it != REMAP_CACHE.end()) { return it->second; }
+    return REMAP_CACHE.emplace(key, make_grade_face_remap(face_size, corner)).first->second;
+}
+
+//! src is expected to be a view into the frame, the face is sampled from it in a single pass without an intermediate copy
+static void grade_face_tilt_correct(const cv::Mat &src, cv::Mat &dst, GradeFaceCorner corner) {
+    const auto &remap = grade_face_remap(src.size(), corner);
+    dst.create(remap.size, src.type());
+    cv::remap(src, dst, remap.map_xy, remap.map_interp, cv::INTER_LINEAR, cv::BORDER_CONSTANT);
 }
 
 cv::Mat crop_grade_option_face(const GradeOptionPartInfo &part, const GradeOptionFaceInfo &face) {
@@ -189,28 +245,28 @@ coro::Promise<AnalyzeResult> ParseGradeOptionsOnModify::research__parse_grade_op
 
     constexpr int UNKNOWN_GRADE = -1;
 
-    static std::map<std::string_view /* utf8 */, int> GRADE_TABLE{
-        {"\xe4\xb8\xad", 0},
-        {"\xe8\x89\xaf", 1},
-        {"\xe4\xbc\x98", 2},
-    };
-
+    //! NOTE: a single misread grade character is ambiguous among the three grades and thus rejected, only extra noise
+    //! around a correct character is tolerated
+    static const auto GRADE_DICTIONARY = [] {
+        FuzzyDictionary dict;
+        dict.insert("\xe4\xb8\xad", 0);
+        dict.insert("\xe8\x89\xaf", 1);
+        dict.insert("\xe4\xbc\x98", 2);
+        return dict;
+    }();
+
+    GradeFaces  grade_faces;
     json::array recog_results;
     for (int i = 0; i < tasks.size(); ++i) {
         int grade = UNKNOWN_GRADE;
 
-        const auto &recog_resp = tasks[i].result;
-        const auto  face_resp  = json::parse(recog_resp.rec_detail);
-        do {
-            //! TODO: fallback to "all" if "best" is not found
-            if (!face_resp->contains("best")) { break; }
-            const auto &best_recog = face_resp->at("best");
-            if (!best_recog.contains("text")) { break; }
-            const auto &text = best_recog.at("text").as_string();
-            if (GRADE_TABLE.count(text)) { grade = GRADE_TABLE[text]; }
-        } while (0);
+        //! TODO: fallback to "all" if "best" is not found
+        if (const auto best_recog = decode_ocr_best(tasks[i].result.rec_detail)) {
+            if (const auto match = GRADE_DICTIONARY.lookup(best_recog->text, 1)) { grade = match->id; }
+        }
 
         const auto &geo = faces[i].origin_geo;
+        grade_faces[i]  = GradeFace{i, grade, geo};
         recog_results.push_back(json::object({
             {"index", i                                               },
             {"grade", grade                                           },
@@ -223,6 +279,8 @@ coro::Promise<AnalyzeResult> ParseGradeOptionsOnModify::research__parse_grade_op
     resp.rec_detail = recog_results.to_string();
     resp.result     = true;
 
+    ResultStore::instance().put(context, task_name, grade_faces);
+
     co_return resp;
 }
 
@@ -276,7 +334,7 @@ coro::Promise<AnalyzeResult> ParseAnecdote::research__parse_anecdote(
 
     timer.restart();
     const auto title_resp = co_await context->run_recognition(image, "OCR", make_ocr_params(roi_title));
-    const auto opt_title  = parse_and_get_best_ocr_record(json::parse(title_resp.rec_detail).value());
+    const auto opt_title  = decode_best_ocr_record(title_resp.rec_detail);
     if (!opt_title.has_value()) {
         LOG_TRACE().noquote() << QString("%1: failed to recognize anecdote title");
         co_return resp;
@@ -292,12 +350,17 @@ coro::Promise<AnalyzeResult> ParseAnecdote::research__parse_anecdote(
     auto current_category = opt.category;
     if (should_match_category) {
         LOG_INFO().noquote() << "no category specified, trying to match category for title:" << QString::fromUtf8(title.text);
+        int min_distance = std::numeric_limits<int>::max();
         for (const auto category : anecdote_set->categories()) {
-            if (anecdote_set->entry(category)->get().entry(title.text).has_value()) {
-                LOG_INFO().noquote() << "matched category:" << QString::fromUtf8(category);
+            const auto match = anecdote_set->entry(category)->get().match_name(title.text);
+            if (match.has_value() && match->distance < min_distance) {
                 current_category = category;
-                break;
+                min_distance     = match->distance;
             }
+            if (min_distance == 0) { break; }
+        }
+        if (min_distance != std::numeric_limits<int>::max()) {
+            LOG_INFO().noquote() << "matched category:" << QString::fromUtf8(current_category);
         }
     }
 
@@ -310,7 +373,7 @@ coro::Promise<AnalyzeResult> ParseAnecdote::research__parse_anecdote(
 
     timer.restart();
     const auto content_resp = co_await context->run_recognition(image, "OCR", make_ocr_params(roi_content));
-    const auto opt_content  = parse_and_get_full_text_ocr_result(json::parse(content_resp.rec_detail).value());
+    const auto opt_content  = decode_full_text_ocr_result(content_resp.rec_detail);
     if (!opt_content.has_value()) {
         LOG_TRACE().noquote() << QString("%1: failed to recognize anecdote content");
         co_return resp;
@@ -323,7 +386,14 @@ coro::Promise<AnalyzeResult> ParseAnecdote::research__parse_anecdote(
                                  .arg(timer.elapsed())
                                  .arg(QString::fromUtf8(content.text));
 
-    const auto opt_entry = category.entry(title.text);
+    //! NOTE: the title is mapped to the closest entry name, so that a single misread character does not cost another
+    //! round of recognition
+    auto opt_entry = category.entry(title.text);
+    if (const auto match = category.match_name(title.text); !opt_entry.has_value() && match.has_value()) {
+        LOG_TRACE().noquote() << "corrected anecdote title" << QString::fromUtf8(title.text) << "to"
+                              << QString::fromUtf8(match->word);
+        opt_entry = category.entry(match->word);
+    }
     if (!opt_entry.has_value()) {
         LOG_TRACE().noquote() << "failed to find anecdote entry for title: " << title.text;
         co_return resp;
@@ -367,6 +437,10 @@ coro::Promise<AnalyzeResult> ParseAnecdote::research__parse_anecdote(
 
     resp.result     = true;
     resp.rec_detail = resp_data.to_string();
+
+    ResultStore::instance().put(
+        context, task_name, AnecdoteMatch{current_category, entry.name(), opt.start_stage, option_score});
+
     co_return resp;
 }
 
@@ -380,6 +454,7 @@ coro::Promise<AnalyzeResult> AnalyzeItemPairs::research__analyze_item_pairs(
     const int     roi_height = roi_all.height / n_vert;
 
     std::vector<cv::Mat> item_images;
+    item_images.reserve(total_items);
     {
         const cv::Mat im(image->height(), image->width(), image->type(), image->raw_data());
         for (int i = 0; i < n_vert; ++i) {
@@ -390,31 +465,10 @@ coro::Promise<AnalyzeResult> AnalyzeItemPairs::research__analyze_item_pairs(
         }
     }
 
-    std::set<int> left_items;
-    for (int i = 0; i < total_items; ++i) { left_items.insert(i); }
-
-    std::vector<std::pair<int, int>> matched_pairs;
-    while (!left_items.empty()) {
-        const int item = *left_items.begin();
-        left_items.erase(item);
-        int    matched_item = -1;
-        double max_score    = std::numeric_limits<double>::lowest();
-        for (const int other : left_items) {
-            const auto &lhs = item_images.at(item);  //<! template image
-            const auto &rhs = item_images.at(other); //<! image to be matched
-            //! NOTE: here 1 equals to (rhs.cols - lhs.cols + 1) and (rhs.rows - lhs.rows + 1)
-            cv::Mat result(1, 1, CV_32FC1);
-            double  score = std::numeric_limits<double>::lowest();
-            cv::matchTemplate(rhs, lhs, result, cv::TM_CCOEFF_NORMED);
-            cv::minMaxLoc(result, nullptr, &score);
-            if (score > max_score) {
-                max_score    = score;
-                matched_item = other;
-            }
-        }
-        left_items.erase(matched_item);
-        matched_pairs.push_back({item, matched_item});
-    }
+    //! NOTE: the pairing is solved over the whole grid at once, a greedy pass would lock in the first ambiguous match
+    //! and leave the tiles it stole to be paired by leftovers
+    const auto descriptors   = TileMatch::describe(item_images);
+    const auto matched_pairs = TileMatch::pair_tiles(TileMatch::similarity(descriptors));
 
     json::array resp_data;
     for (const auto &[item, other] : matched_pairs) { resp_data.push_back(json::array({item, other})); }
@@ -425,6 +479,8 @@ coro::Promise<AnalyzeResult> AnalyzeItemPairs::research__analyze_item_pairs(
 
     LOG_TRACE().noquote() << "matched pairs:" << resp.rec_detail;
 
+    ResultStore::instance().put<ItemPairs>(context, task_name, matched_pairs);
+
     co_return resp;
 }
 
@@ -477,20 +533,22 @@ coro::Promise<AnalyzeResult> GetCandidateBuffs::research__get_candidate_buffs(
         co_return resp;
     }
 
-    json::array resp_data;
+    CandidateBuffs buffs;
+    json::array    resp_data;
     {
         const int r = total_buff / 2;
         for (int i = -r; i <= r; ++i) {
             const MaaRect roi{qBound(0, center_roi.x + i * dx, im.cols), center_roi.y, center_roi.width, center_roi.height};
             const auto    recog_resp = co_await context->run_recognition(image, "OCR", make_ocr_params(roi));
-            const auto    data       = json::parse(recog_resp.rec_detail);
-            if (!data->contains("best") || data->at("best").at("score").as_double() < threshould) { co_return resp; }
-            const auto buff_name = QString::fromUtf8(data->at("best").at("text").as_string());
+            const auto    best_recog = decode_ocr_best(recog_resp.rec_detail);
+            if (!best_recog.has_value() || best_recog->score < threshould) { co_return resp; }
+            const auto buff_name = QString::fromUtf8(best_recog->text);
             if (buff_name.contains(QChar(U'·'))) {
-                resp_data.push_back(buff_name.split(QChar(U'·')).back().toStdString());
+                buffs.push_back(buff_name.split(QChar(U'·')).back().toStdString());
             } else {
-                resp_data.push_back(buff_name.toStdString());
+                buffs.push_back(buff_name.toStdString());
             }
+            resp_data.push_back(buffs.back());
         }
     }
 
@@ -499,6 +557,8 @@ coro::Promise<AnalyzeResult> GetCandidateBuffs::research__get_candidate_buffs(
 
     LOG_INFO().noquote() << "found candidate buffs:" << QString::fromUtf8(resp.rec_detail);
 
+    ResultStore::instance().put(context, task_name, std::move(buffs));
+
     co_return resp;
 }
 
@@ -15,18 +15,32 @@
 
 #pragma once
 
+#include "../DeviceSession.h"
+
 #include <MaaPP/MaaPP.hpp>
+#include <array>
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace Rec::Research {
 
+struct GradeFace {
+    int     index;
+    int     grade; //<! -1 if unknown, 0~2 from the lowest to the highest
+    MaaRect box;
+};
+
+using GradeFaces = std::array<GradeFace, 6>;
+
 class ParseGradeOptionsOnModify {
 public:
     static std::string name() {
         return "Research.ParseGradeOptionsOnModify";
     }
 
-    static std::shared_ptr<maa::CustomRecognizer> make() {
-        return maa::CustomRecognizer::make(&ParseGradeOptionsOnModify::research__parse_grade_options_on_modify);
+    static std::shared_ptr<maa::CustomRecognizer> make(std::shared_ptr<DeviceSession> session = nullptr) {
+        return DeviceSession::wrap_recognizer(session, &ParseGradeOptionsOnModify::research__parse_grade_options_on_modify);
     }
 
 private:
@@ -40,14 +54,21 @@ struct ParseAnecdoteParam {
     int         start_stage;         //<! default: -1, means auto detect
 };
 
+struct AnecdoteMatch {
+    std::string category;
+    std::string name;
+    int         stage;
+    double      score;
+};
+
 class ParseAnecdote {
 public:
     static std::string name() {
         return "Research.ParseAnecdote";
     }
 
-    static std::shared_ptr<maa::CustomRecognizer> make() {
-        return maa::CustomRecognizer::make(&ParseAnecdote::research__parse_anecdote);
+    static std::shared_ptr<maa::CustomRecognizer> make(std::shared_ptr<DeviceSession> session = nullptr) {
+        return DeviceSession::wrap_recognizer(session, &ParseAnecdote::research__parse_anecdote);
     }
 
     static bool parse_params(ParseAnecdoteParam &param_out, MaaStringView raw_param);
@@ -57,14 +78,16 @@ private:
         maa::SyncContextHandle context, maa::ImageHandle image, std::string_view task_name, std::string_view param);
 };
 
+using ItemPairs = std::vector<std::pair<int, int>>;
+
 class AnalyzeItemPairs {
 public:
     static std::string name() {
         return "Research.AnalyzeItemPairs";
     }
 
-    static std::shared_ptr<maa::CustomRecognizer> make() {
-        return maa::CustomRecognizer::make(&AnalyzeItemPairs::research__analyze_item_pairs);
+    static std::shared_ptr<maa::CustomRecognizer> make(std::shared_ptr<DeviceSession> session = nullptr) {
+        return DeviceSession::wrap_recognizer(session, &AnalyzeItemPairs::research__analyze_item_pairs);
     }
 
 private:
@@ -72,14 +95,16 @@ private:
         maa::SyncContextHandle context, maa::ImageHandle image, std::string_view task_name, std::string_view param);
 };
 
+using CandidateBuffs = std::vector<std::string>; //<! utf8 buff names from left to right
+
 class GetCandidateBuffs {
 public:
     static std::string name() {
         return "Research.GetCandidateBuffs";
     }
 
-    static std::shared_ptr<maa::CustomRecognizer> make() {
-        return maa::CustomRecognizer::make(&GetCandidateBuffs::research__get_candidate_buffs);
+    static std::shared_ptr<maa::CustomRecognizer> make(std::shared_ptr<DeviceSession> session = nullptr) {
+        return DeviceSession::wrap_recognizer(session, &GetCandidateBuffs::research__get_candidate_buffs);
     }
 
 private:
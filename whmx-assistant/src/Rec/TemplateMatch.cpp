@@ -0,0 +1,251 @@
+/* Copyright 2024 周上行Ryer
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#include "TemplateMatch.h"
+#include "../Logger.h"
+#include "../Trace.h"
+
+#include <QtCore/QDebug>
+#include <QtCore/QString>
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+
+namespace Rec::TemplateMatch {
+
+using namespace maa;
+
+static constexpr double MIN_DENOMINATOR = 1e-6;
+
+//! preprocessed roi of the frame at one pyramid level
+struct SearchRegion {
+    cv::Mat image;   //<! CV_8UC3
+    cv::Mat image_f; //<! CV_32FC3
+    cv::Mat sum;     //<! integral image, CV_64FC3
+    cv::Mat sqsum;   //<! integral image of the squares, CV_64FC3
+};
+
+static TemplateLevel make_template_level(cv::Mat image, cv::Mat mask) {
+    TemplateLevel level;
+    level.image = image;
+    level.mask  = mask;
+    image.convertTo(level.zero_mean, CV_32F);
+    level.zero_mean -= cv::mean(level.zero_mean);
+    level.norm       = cv::norm(level.zero_mean);
+    return level;
+}
+
+static std::shared_ptr<const Template> load_template(const std::string &path, bool green_mask, int pyramid_levels) {
+    const auto image = cv::imread(path, cv::IMREAD_COLOR);
+    if (image.empty()) { return nullptr; }
+
+    cv::Mat mask;
+    if (green_mask) {
+        cv::inRange(image, cv::Scalar(0, 255, 0), cv::Scalar(0, 255, 0), mask);
+        cv::bitwise_not(mask, mask);
+    }
+
+    auto tpl = std::make_shared<Template>();
+    tpl->levels.push_back(make_template_level(image, mask));
+    while (static_cast<int>(tpl->levels.size()) <= pyramid_levels) {
+        const auto &last = tpl->levels.back();
+        if (std::min(last.image.cols, last.image.rows) < MIN_PYRAMID_SIDE * 2) { break; }
+        cv::Mat next_image;
+        cv::Mat next_mask;
+        cv::pyrDown(last.image, next_image);
+        if (!last.mask.empty()) { cv::resize(last.mask, next_mask, next_image.size(), 0, 0, cv::INTER_NEAREST); }
+        tpl->levels.push_back(make_template_level(next_image, next_mask));
+    }
+    return tpl;
+}
+
+TemplateCache &TemplateCache::instance() {
+    static TemplateCache cache;
+    return cache;
+}
+
+void TemplateCache::reset(const std::string &image_dir) {
+    std::lock_guard lock(lock_);
+    image_dir_ = image_dir;
+    templates_.clear();
+}
+
+std::shared_ptr<const Template> TemplateCache::get(const std::string &name, bool green_mask, int pyramid_levels) {
+    pyramid_levels = std::clamp(pyramid_levels, 0, MAX_PYRAMID_LEVELS);
+
+    std::string path;
+    {
+        std::lock_guard lock(lock_);
+        const Key       key{name, green_mask};
+        if (auto it = templates_.find(key); it != templates_.end()) {
+            //! NOTE: a template which is too small for more levels never grows them, so it is not reloaded either
+            const auto &tpl = it->second;
+            const bool  enough_levels =
+                static_cast<int>(tpl->levels.size()) > pyramid_levels
+                || std::min(tpl->levels.back().image.cols, tpl->levels.back().image.rows) < MIN_PYRAMID_SIDE * 2;
+            if (enough_levels) { return tpl; }
+        }
+        path = (std::filesystem::path(image_dir_) / name).string();
+    }
+
+    //! NOTE: loaded outside of the lock, a concurrent load of the same template only wastes the work
+    auto tpl = load_template(path, green_mask, pyramid_levels);
+    if (!tpl) {
+        LOG_WARN().noquote() << "template match: failed to load template" << QString::fromStdString(path);
+        return nullptr;
+    }
+
+    std::lock_guard lock(lock_);
+    templates_[Key{name, green_mask}] = tpl;
+    return tpl;
+}
+
+static MaaRect clip_roi(const MaaRect &roi, const cv::Size &size) {
+    if (roi.width <= 0 || roi.height <= 0) { return MaaRect{0, 0, size.width, size.height}; }
+    const int x0 = std::clamp(roi.x, 0, size.width);
+    const int y0 = std::clamp(roi.y, 0, size.height);
+    const int x1 = std::clamp(roi.x + roi.width, 0, size.width);
+    const int y1 = std::clamp(roi.y + roi.height, 0, size.height);
+    return MaaRect{x0, y0, x1 - x0, y1 - y0};
+}
+
+static SearchRegion make_search_region(cv::Mat image) {
+    SearchRegion region;
+    region.image = image;
+    image.convertTo(region.image_f, CV_32F);
+    cv::integral(image, region.sum, region.sqsum, CV_64F, CV_64F);
+    return region;
+}
+
+//! scores of the template placed at every top-left position in the given rect of positions
+static cv::Mat score_map(const SearchRegion &region, const TemplateLevel &tpl, const cv::Rect &positions) {
+    const int      tw = tpl.image.cols;
+    const int      th = tpl.image.rows;
+    const cv::Rect window(positions.x, positions.y, positions.width + tw - 1, positions.height + th - 1);
+
+    cv::Mat result;
+    if (!tpl.mask.empty()) {
+        cv::matchTemplate(region.image(window), tpl.image, result, cv::TM_CCOEFF_NORMED, tpl.mask);
+        cv::patchNaNs(result, 0);
+        cv::min(result, 1.0, result);
+        return result;
+    }
+
+    //! NOTE: the template is zero-mean, so the plain correlation already equals the numerator of the normalized
+    //! correlation coefficient, the window statistics come from the integral images in constant time
+    cv::matchTemplate(region.image_f(window), tpl.zero_mean, result, cv::TM_CCORR);
+
+    const int    cn = region.image.channels();
+    const double n  = static_cast<double>(tw) * th;
+    for (int y = 0; y < result.rows; ++y) {
+        const auto *sum_top    = region.sum.ptr<double>(positions.y + y);
+        const auto *sum_bottom = region.sum.ptr<double>(positions.y + y + th);
+        const auto *sq_top     = region.sqsum.ptr<double>(positions.y + y);
+        const auto *sq_bottom  = region.sqsum.ptr<double>(positions.y + y + th);
+        auto       *row        = result.ptr<float>(y);
+        for (int x = 0; x < result.cols; ++x) {
+            const int left  = (positions.x + x) * cn;
+            const int right = (positions.x + x + tw) * cn;
+            double    var   = 0;
+            for (int c = 0; c < cn; ++c) {
+                const double s  = sum_bottom[right + c] - sum_bottom[left + c] - sum_top[right + c] + sum_top[left + c];
+                const double sq = sq_bottom[right + c] - sq_bottom[left + c] - sq_top[right + c] + sq_top[left + c];
+                var += sq - s * s / n;
+            }
+            const double denominator = std::sqrt(std::max(var, 0.0)) * tpl.norm;
+            row[x] = denominator > MIN_DENOMINATOR ? std::clamp(row[x] / denominator, -1.0, 1.0) : 0.0;
+        }
+    }
+    return result;
+}
+
+std::vector<Match> match(const cv::Mat &frame, const std::vector<Query> &queries) {
+    Trace::Span span("rec", "template_match");
+    span.attr("queries", queries.size());
+
+    auto &cache = TemplateCache::instance();
+
+    //! NOTE: keyed by the clipped roi and the pyramid level, queries scanning the same slot share one region
+    std::map<std::tuple<int, int, int, int, int>, SearchRegion> regions;
+    const auto region_of = [&frame, &regions](const MaaRect &roi, int level) -> const SearchRegion & {
+        const auto key = std::make_tuple(roi.x, roi.y, roi.width, roi.height, level);
+        if (auto it = regions.find(key); it != regions.end()) { return it->second; }
+        cv::Mat image = frame.rowRange(roi.y, roi.y + roi.height).colRange(roi.x, roi.x + roi.width);
+        for (int i = 0; i < level; ++i) { cv::pyrDown(image, image); }
+        return regions.emplace(key, make_search_region(image)).first->second;
+    };
+
+    std::vector<Match> matches;
+    matches.reserve(queries.size());
+    for (const auto &query : queries) {
+        const auto roi = clip_roi(query.roi, frame.size());
+        const auto tpl = cache.get(query.template_name, query.green_mask, query.pyramid_levels);
+
+        Match resp{false, 0.0, MaaRect{roi.x, roi.y, 0, 0}};
+        if (!tpl || tpl->levels[0].image.type() != frame.type()) {
+            matches.push_back(resp);
+            continue;
+        }
+
+        const auto &full = tpl->levels[0];
+        const int   dx   = roi.width - full.image.cols;
+        const int   dy   = roi.height - full.image.rows;
+        if (dx < 0 || dy < 0) {
+            matches.push_back(resp);
+            continue;
+        }
+
+        //! NOTE: the coarse level only locates the candidate, the score is always taken at the original scale around it
+        cv::Rect   positions(0, 0, dx + 1, dy + 1);
+        const auto level = std::min<int>(query.pyramid_levels, tpl->levels.size() - 1);
+        if (level > 0 && positions.area() > 1) {
+            const auto &coarse_tpl    = tpl->levels[level];
+            const auto &coarse_region = region_of(roi, level);
+            const int   coarse_dx     = coarse_region.image.cols - coarse_tpl.image.cols;
+            const int   coarse_dy     = coarse_region.image.rows - coarse_tpl.image.rows;
+            if (coarse_dx >= 0 && coarse_dy >= 0) {
+                const auto coarse = score_map(coarse_region, coarse_tpl, cv::Rect(0, 0, coarse_dx + 1, coarse_dy + 1));
+                cv::Point  loc;
+                cv::minMaxLoc(coarse, nullptr, nullptr, nullptr, &loc);
+                const int scale = 1 << level;
+                const int x0    = std::clamp(loc.x * scale - scale, 0, dx);
+                const int y0    = std::clamp(loc.y * scale - scale, 0, dy);
+                const int x1    = std::clamp(loc.x * scale + scale, 0, dx);
+                const int y1    = std::clamp(loc.y * scale + scale, 0, dy);
+                positions       = cv::Rect(x0, y0, x1 - x0 + 1, y1 - y0 + 1);
+            }
+        }
+
+        const auto scores = score_map(region_of(roi, 0), full, positions);
+        double     score  = 0;
+        cv::Point  loc;
+        cv::minMaxLoc(scores, nullptr, &score, nullptr, &loc);
+
+        resp.hit   = score >= query.threshold;
+        resp.score = score;
+        resp.box   = MaaRect{roi.x + positions.x + loc.x, roi.y + positions.y + loc.y, full.image.cols, full.image.rows};
+        matches.push_back(resp);
+    }
+
+    return matches;
+}
+
+std::vector<Match> match(const ImageHandle &image, const std::vector<Query> &queries) {
+    const cv::Mat frame(image->height(), image->width(), image->type(), image->raw_data());
+    return match(frame, queries);
+}
+
+} // namespace Rec::TemplateMatch
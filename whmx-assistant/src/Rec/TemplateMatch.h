@@ -0,0 +1,87 @@
+/* Copyright 2024 周上行Ryer
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#pragma once
+
+#include <MaaPP/MaaPP.hpp>
+#include <opencv2/core.hpp>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <vector>
+
+//! in-process template matching over a single screencap, a cheaper alternative to a run_recognition("TemplateMatch")
+//! per roi in custom actions which scan a row of slots
+//! NOTE: scores follow the TM_CCOEFF_NORMED method of the maa TemplateMatch recognition, so the thresholds written
+//! for the pipeline carry over
+namespace Rec::TemplateMatch {
+
+constexpr double DEFAULT_THRESHOLD  = 0.7;
+constexpr int    MIN_PYRAMID_SIDE   = 16; //<! a template is not downscaled below this side
+constexpr int    MAX_PYRAMID_LEVELS = 3;
+
+struct Query {
+    std::string template_name;                    //<! relative to the image dir of the resource, e.g. Combat/FreeSlot.png
+    MaaRect     roi{0, 0, 0, 0};                  //<! empty roi means the whole frame
+    bool        green_mask     = false;           //<! ignore the pure green (0, 255, 0) pixels of the template
+    double      threshold      = DEFAULT_THRESHOLD;
+    int         pyramid_levels = 0;               //<! coarse-to-fine search from the given level, 0 to disable
+};
+
+struct Match {
+    bool    hit;   //<! score reaches the threshold
+    double  score; //<! best score in the roi, 0 if the template does not fit into the roi
+    MaaRect box;
+};
+
+struct TemplateLevel {
+    cv::Mat image;     //<! CV_8UC3
+    cv::Mat mask;      //<! CV_8UC1, empty if the template is not masked
+    cv::Mat zero_mean; //<! CV_32FC3, image minus its per-channel mean
+    double  norm;      //<! L2 norm of zero_mean
+};
+
+struct Template {
+    std::vector<TemplateLevel> levels; //<! levels[0] is the original image, each next level is downscaled by 2
+};
+
+//! templates are loaded once and kept with their precomputed statistics until the resource is reloaded
+class TemplateCache {
+public:
+    static TemplateCache &instance();
+
+    //! drops every cached template, called whenever the resource is (re)loaded
+    void reset(const std::string &image_dir);
+
+    //! nullptr if the image can not be loaded
+    std::shared_ptr<const Template> get(const std::string &name, bool green_mask, int pyramid_levels);
+
+protected:
+    TemplateCache() = default;
+
+private:
+    using Key = std::tuple<std::string, bool>;
+
+    std::mutex                                     lock_;
+    std::string                                    image_dir_;
+    std::map<Key, std::shared_ptr<const Template>> templates_;
+};
+
+//! evaluate every query against the frame, queries on the same roi share the preprocessed search region
+std::vector<Match> match(const cv::Mat &frame, const std::vector<Query> &queries);
+std::vector<Match> match(const maa::ImageHandle &image, const std::vector<Query> &queries);
+
+} // namespace Rec::TemplateMatch
@@ -0,0 +1,162 @@
+/* Copyright 2024 周上行Ryer
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "TileMatch.h"
+
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+namespace Rec::TileMatch {
+
+static cv::Mat to_bgr(const cv::Mat &tile) {
+    cv::Mat bgr;
+    if (false) {
+    } else if (tile.channels() == 4) {
+        cv::cvtColor(tile, bgr, cv::COLOR_BGRA2BGR);
+    } else if (tile.channels() == 1) {
+        cv::cvtColor(tile, bgr, cv::COLOR_GRAY2BGR);
+    } else {
+        bgr = tile;
+    }
+    return bgr;
+}
+
+//! zero-mean unit-norm thumbnail, the dot product of two of them is their normalized correlation
+static void describe_shape(const cv::Mat &bgr, cv::Mat row) {
+    cv::Mat gray;
+    cv::Mat thumbnail;
+    cv::cvtColor(bgr, gray, cv::COLOR_BGR2GRAY);
+    cv::resize(gray, thumbnail, cv::Size(THUMBNAIL_SIZE, THUMBNAIL_SIZE), 0, 0, cv::INTER_AREA);
+    thumbnail.reshape(1, 1).convertTo(row, CV_32F);
+    row -= cv::mean(row)[0];
+    if (const double norm = cv::norm(row); norm > 0) { row /= norm; }
+}
+
+//! square root of the normalized hue-saturation histogram, the dot product of two of them is the bhattacharyya
+//! coefficient
+static void describe_color(const cv::Mat &bgr, cv::Mat row) {
+    cv::Mat hsv;
+    cv::cvtColor(bgr, hsv, cv::COLOR_BGR2HSV);
+
+    const int   channels[]{0, 1};
+    const int   bins[]{HUE_BINS, SAT_BINS};
+    const float hue_range[]{0, 180};
+    const float sat_range[]{0, 256};
+    const float *ranges[]{hue_range, sat_range};
+
+    cv::Mat hist;
+    cv::calcHist(&hsv, 1, channels, cv::Mat(), hist, 2, bins, ranges);
+    hist = hist.reshape(1, 1);
+    if (const double total = cv::sum(hist)[0]; total > 0) { hist /= total; }
+    cv::sqrt(hist, row);
+}
+
+cv::Mat describe(const std::vector<cv::Mat> &tiles) {
+    const int shape_size = THUMBNAIL_SIZE * THUMBNAIL_SIZE;
+    const int color_size = HUE_BINS * SAT_BINS;
+
+    cv::Mat descriptors(static_cast<int>(tiles.size()), shape_size + color_size, CV_32F);
+    for (int i = 0; i < descriptors.rows; ++i) {
+        const auto bgr   = to_bgr(tiles[i]);
+        auto       shape = descriptors.row(i).colRange(0, shape_size);
+        auto       color = descriptors.row(i).colRange(shape_size, shape_size + color_size);
+        describe_shape(bgr, shape);
+        describe_color(bgr, color);
+        shape *= std::sqrt(SHAPE_WEIGHT);
+        color *= std::sqrt(1.0 - SHAPE_WEIGHT);
+    }
+    return descriptors;
+}
+
+cv::Mat similarity(const cv::Mat &descriptors) {
+    cv::Mat resp;
+    cv::mulTransposed(descriptors, resp, false, cv::noArray(), 1.0, CV_32F);
+    return resp;
+}
+
+static std::vector<std::pair<int, int>> pair_tiles_exact(const cv::Mat &similarity) {
+    const int  n    = similarity.rows;
+    const int  full = (1 << n) - 1;
+    const bool odd  = n % 2 == 1;
+
+    //! NOTE: dp over the set of settled tiles, the lowest unsettled tile is always settled next, either paired with a
+    //! later tile or left alone when the count is odd, an odd number of settled tiles means the lone tile is taken
+    std::vector<float>               best(full + 1, std::numeric_limits<float>::lowest());
+    std::vector<std::pair<int, int>> choice(full + 1, {-1, -1});
+    best[0] = 0.f;
+    for (int mask = 0; mask < full; ++mask) {
+        if (best[mask] == std::numeric_limits<float>::lowest()) { continue; }
+        int i = 0;
+        while (mask & (1 << i)) { ++i; }
+        for (int j = i + 1; j < n; ++j) {
+            if (mask & (1 << j)) { continue; }
+            const int   next  = mask | (1 << i) | (1 << j);
+            const float score = best[mask] + similarity.at<float>(i, j);
+            if (score > best[next]) {
+                best[next]   = score;
+                choice[next] = {i, j};
+            }
+        }
+        const bool lone_taken = std::popcount(static_cast<unsigned>(mask)) % 2 == 1;
+        if (const int next = mask | (1 << i); odd && !lone_taken && best[mask] > best[next]) {
+            best[next]   = best[mask];
+            choice[next] = {i, -1};
+        }
+    }
+
+    std::vector<std::pair<int, int>> pairs;
+    for (int mask = full; mask != 0;) {
+        const auto [i, j] = choice[mask];
+        if (j != -1) { pairs.push_back({i, j}); }
+        mask &= ~(1 << i);
+        if (j != -1) { mask &= ~(1 << j); }
+    }
+    std::reverse(pairs.begin(), pairs.end());
+    return pairs;
+}
+
+static std::vector<std::pair<int, int>> pair_tiles_greedy(const cv::Mat &similarity) {
+    const int n = similarity.rows;
+
+    std::vector<std::pair<int, int>> edges;
+    for (int i = 0; i < n; ++i) {
+        for (int j = i + 1; j < n; ++j) { edges.push_back({i, j}); }
+    }
+    std::sort(edges.begin(), edges.end(), [&similarity](const auto &lhs, const auto &rhs) {
+        return similarity.at<float>(lhs.first, lhs.second) > similarity.at<float>(rhs.first, rhs.second);
+    });
+
+    std::vector<bool>                settled(n, false);
+    std::vector<std::pair<int, int>> pairs;
+    for (const auto &[i, j] : edges) {
+        if (settled[i] || settled[j]) { continue; }
+        settled[i] = true;
+        settled[j] = true;
+        pairs.push_back({i, j});
+    }
+    return pairs;
+}
+
+std::vector<std::pair<int, int>> pair_tiles(const cv::Mat &similarity) {
+    if (similarity.rows < 2) { return {}; }
+    if (similarity.rows <= MAX_EXACT_TILES) { return pair_tiles_exact(similarity); }
+    return pair_tiles_greedy(similarity);
+}
+
+} // namespace Rec::TileMatch
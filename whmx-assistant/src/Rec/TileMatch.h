@@ -0,0 +1,44 @@
+/* Copyright 2024 周上行Ryer
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <utility>
+#include <vector>
+
+//! tile matching engine for the pairing minigames, e.g. Rec::Research::AnalyzeItemPairs
+//! NOTE: every tile is reduced to a compact descriptor once, the pairwise similarities then come from a single matrix
+//! product and the pairing is solved globally, so that one ambiguous tile does not cascade into the other pairs
+namespace Rec::TileMatch {
+
+constexpr int    THUMBNAIL_SIZE  = 16;  //<! side of the downscaled grayscale thumbnail
+constexpr int    HUE_BINS        = 12;
+constexpr int    SAT_BINS        = 4;
+constexpr double SHAPE_WEIGHT    = 0.7; //<! weight of the thumbnail correlation against the color histogram
+constexpr int    MAX_EXACT_TILES = 20;  //<! the exact matching is exponential in the number of tiles
+
+//! one row per tile, every row is a unit vector so that the dot product of two rows is their similarity in [-1, 1]
+cv::Mat describe(const std::vector<cv::Mat> &tiles);
+
+//! n x n similarity matrix of the descriptors
+cv::Mat similarity(const cv::Mat &descriptors);
+
+//! maximum-weight perfect matching on the similarity matrix, a tile is left unpaired only when the number of tiles is
+//! odd
+//! NOTE: solved exactly up to MAX_EXACT_TILES tiles, larger grids fallback to a global greedy pairing
+std::vector<std::pair<int, int>> pair_tiles(const cv::Mat &similarity);
+
+} // namespace Rec::TileMatch
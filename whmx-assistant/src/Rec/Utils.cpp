@@ -15,6 +15,9 @@
 
 #include "Utils.h"
 #include "../Logger.h"
+#include "../Decode.h"
+#include "../FrameStream.h"
+#include "../Trace.h"
 
 #include <QtCore/QDebug>
 #include <QtCore/QUuid>
@@ -65,14 +68,16 @@ coro::Promise<AnalyzeResult> TwoStageTest::utils__two_stage_test(
         {recognition, opt.recog_task},
     };
 
+    uint64_t      frame_id = 0;
     QElapsedTimer timer;
     timer.start();
     do {
-        co_await context->screencap(image);
-        const auto recog_resp = co_await context->run_recognition(image, recognition, recog_param);
-        const auto result     = json::parse(recog_resp.rec_detail).value_or(json::object()).as_object();
-        Q_ASSERT(result.contains("best"));
-        if (const auto best = result.at("best").as_object(); !best.empty()) { co_return recog_resp; }
+        //! NOTE: the next frame is captured in background while the current one is being recognized
+        const auto frame      = co_await FrameStream::capture_after(context, frame_id);
+        frame_id              = frame.id;
+        TRACE_SCOPE("rec", recognition);
+        const auto recog_resp = co_await context->run_recognition(frame.image, recognition, recog_param);
+        if (has_expected_match(recog_resp.rec_detail)) { co_return recog_resp; }
     } while (timer.elapsed() < opt.timeout);
 
     co_return resp;
@@ -15,6 +15,8 @@
 
 #pragma once
 
+#include "../DeviceSession.h"
+
 #include <MaaPP/MaaPP.hpp>
 
 namespace Rec::Utils {
@@ -31,8 +33,8 @@ public:
         return "Utils.TwoStageTest";
     }
 
-    static std::shared_ptr<maa::CustomRecognizer> make() {
-        return maa::CustomRecognizer::make(&TwoStageTest::utils__two_stage_test);
+    static std::shared_ptr<maa::CustomRecognizer> make(std::shared_ptr<DeviceSession> session = nullptr) {
+        return DeviceSession::wrap_recognizer(session, &TwoStageTest::utils__two_stage_test);
     }
 
     static bool parse_params(TwoStageTestParam &param_out, MaaStringView raw_param);
@@ -14,9 +14,11 @@
 */
 
 #include "ReferenceDataSet.h"
+#include "Logger.h"
 
 #include <filesystem>
 #include <fstream>
+#include <functional>
 #include <QtCore/QDebug>
 #include <QtCore/QCryptographicHash>
 
@@ -98,9 +100,90 @@ std::optional<ResearchAnecdoteRecord> ResearchAnecdoteRecord::parse(const std::s
 
     if (resp.option_stages_.empty()) { return std::nullopt; }
 
+    resp.compile_plan();
+
     return std::make_optional(std::move(resp));
 }
 
+void ResearchAnecdoteRecord::compile_plan() {
+    enum class Mark {
+        Unvisited,
+        Visiting,
+        Done,
+    };
+
+    const int total = option_stages_.size();
+
+    plan_.assign(total, ResearchAnecdotePlannedChoice{-1, -1, 0.0});
+    std::vector<Mark> marks(total, Mark::Unvisited);
+    cyclic_ = false;
+
+    //! NOTE: stages form a graph through the next hints, the value of a stage is solved after the stages it leads to,
+    //! an edge back to a stage which is still being solved closes a cycle and is valued as the end of the event
+    std::function<double(int)> solve = [&](int stage) -> double {
+        if (marks[stage] == Mark::Done) { return plan_[stage].value; }
+        marks[stage] = Mark::Visiting;
+
+        const auto         &group = option_stages_[stage];
+        auto                best  = ResearchAnecdotePlannedChoice{-1, -1, -1.0};
+        std::vector<double> values(group.options.size());
+        for (int i = 0; i < group.options.size(); ++i) {
+            const auto &option = group.options[i];
+            const int   next   = option.next_entry_hint >= 0 && option.next_entry_hint < total ? option.next_entry_hint : -1;
+
+            double value = option.positive ? 1.0 : 0.0;
+            if (false) {
+            } else if (option.type == ResearchAnecdoteOption::Random) {
+                value = RANDOM_OPTION_VALUE;
+            } else if (next != -1 && marks[next] == Mark::Visiting) {
+                cyclic_ = true;
+            } else if (next != -1) {
+                value += solve(next);
+            }
+
+            values[i] = value;
+
+            //! NOTE: ties keep the former option, i.e. the first positive one as resolved before
+            if (value > best.value) { best = ResearchAnecdotePlannedChoice{i, next, value}; }
+        }
+
+        if (group.has_recommended_option()) {
+            const auto &option = group.recommended_option();
+            const int   next   = option.next_entry_hint >= 0 && option.next_entry_hint < total ? option.next_entry_hint : -1;
+            best.option        = group.recommended;
+            best.next_stage    = next;
+            best.value         = values[group.recommended];
+        } else if (best.value <= 0.0) {
+            best.random = true;
+        }
+
+        marks[stage] = Mark::Done;
+        plan_[stage] = best;
+        return best.value;
+    };
+
+    for (int stage = 0; stage < total; ++stage) { solve(stage); }
+
+    std::vector<bool> reachable(total, false);
+    std::vector<int>  pending{0};
+    reachable[0] = true;
+    while (!pending.empty()) {
+        const int stage = pending.back();
+        pending.pop_back();
+        for (const auto &option : option_stages_[stage].options) {
+            const int next = option.next_entry_hint;
+            if (next < 0 || next >= total || reachable[next]) { continue; }
+            reachable[next] = true;
+            pending.push_back(next);
+        }
+    }
+
+    unreachable_stages_.clear();
+    for (int stage = 1; stage < total; ++stage) {
+        if (!reachable[stage]) { unreachable_stages_.push_back(stage); }
+    }
+}
+
 std::optional<ResearchAnecdoteEntry> ResearchAnecdoteEntry::parse(const std::string &category, const json::value &value) {
     if (!value.is_object()) { return std::nullopt; }
 
@@ -110,12 +193,22 @@ std::optional<ResearchAnecdoteEntry> ResearchAnecdoteEntry::parse(const std::str
     for (const auto &[name, entry] : value.as_object()) {
         if (auto opt = ResearchAnecdoteRecord::parse(name, entry)) {
             //! FIXME: resolve duplicate entries
+            if (opt->cyclic()) {
+                LOG_WARN().noquote() << "anecdote" << QString::fromUtf8(category) << QString::fromUtf8(name)
+                                     << "has cyclic stages";
+            }
+            if (const auto &stages = opt->unreachable_stages(); !stages.empty()) {
+                LOG_WARN().noquote() << "anecdote" << QString::fromUtf8(category) << QString::fromUtf8(name)
+                                     << "has unreachable stages" << QList<int>(stages.begin(), stages.end());
+            }
             resp.entries_.insert_or_assign(name, std::move(opt.value()));
         } else {
             return std::nullopt;
         }
     }
 
+    for (int id = 0; const auto &[name, _] : resp.entries_) { resp.names_.insert(name, id++); }
+
     return std::make_optional(std::move(resp));
 }
 
@@ -15,6 +15,8 @@
 
 #pragma once
 
+#include "FuzzyDictionary.h"
+
 #include <meojson/json.hpp>
 #include <map>
 #include <string>
@@ -75,8 +77,19 @@ public:
     std::vector<ResearchAnecdoteOption> options;
 };
 
+//! precomputed choice of one stage, see ResearchAnecdoteRecord::planned_choice
+struct ResearchAnecdotePlannedChoice {
+    int    option;         //<! index of the option to take
+    int    next_stage;     //<! stage hinted by the option, -1 if the event ends after it
+    double value;          //<! expected number of positive options taken from this stage on
+    bool   random = false; //<! no option is worth anything, the option is left to be chosen at random on resolving
+};
+
 class ResearchAnecdoteRecord {
 public:
+    //! expected value of a random option, its outcome is unknown until it is taken
+    static constexpr double RANDOM_OPTION_VALUE = 0.5;
+
     static std::optional<ResearchAnecdoteRecord> parse(const std::string &name, const std::string &raw_text) {
         if (const auto opt = json::parse(raw_text)) {
             return parse(name, opt.value());
@@ -99,6 +112,21 @@ public:
         return option_stages_.at(index);
     }
 
+    //! the best choice of the stage, the recommended option always wins over the planned one
+    const ResearchAnecdotePlannedChoice &planned_choice(int stage) const {
+        return plan_.at(stage);
+    }
+
+    //! stages which can not be reached from the first one, excluding the first one itself
+    const std::vector<int> &unreachable_stages() const {
+        return unreachable_stages_;
+    }
+
+    //! whether a chain of options leads back to a former stage
+    bool cyclic() const {
+        return cyclic_;
+    }
+
     auto as_stage_range() const {
         class Range {
         public:
@@ -120,9 +148,15 @@ public:
         return Range(*this);
     }
 
+protected:
+    void compile_plan();
+
 private:
-    std::string                              name_;
-    std::vector<ResearchAnecdoteOptionGroup> option_stages_;
+    std::string                                name_;
+    std::vector<ResearchAnecdoteOptionGroup>   option_stages_;
+    std::vector<ResearchAnecdotePlannedChoice> plan_;
+    std::vector<int>                           unreachable_stages_;
+    bool                                       cyclic_ = false;
 };
 
 class ResearchAnecdoteEntry {
@@ -151,9 +185,15 @@ public:
         return list;
     }
 
+    //! closest entry name to the ocr text, see FuzzyDictionary::lookup
+    std::optional<FuzzyDictionary::Match> match_name(const std::string &text) const {
+        return names_.lookup(text);
+    }
+
 private:
     std::string                                   category_;
     std::map<std::string, ResearchAnecdoteRecord> entries_;
+    FuzzyDictionary                               names_;
 };
 
 struct ResearchAnecdoteSet {
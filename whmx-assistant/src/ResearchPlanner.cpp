@@ -0,0 +1,111 @@
+/* Copyright 2024 周上行Ryer
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#include "ResearchPlanner.h"
+#include "DeviceSession.h"
+
+#include <QtCore/QSet>
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+using namespace maa;
+
+std::shared_ptr<ResearchPlanner> ResearchPlanner::create() {
+    return std::shared_ptr<ResearchPlanner>(new ResearchPlanner);
+}
+
+std::shared_ptr<ResearchPlanner> ResearchPlanner::of(const SyncContextHandle &context) {
+    //! NOTE: the sync context is a fresh wrapper on every callback, only the session stays the same across rounds
+    if (auto session = DeviceSession::of(context)) { return session->research_planner(); }
+    static const auto UNBOUND_PLANNER = create();
+    return UNBOUND_PLANNER;
+}
+
+ResearchPlanner::ResearchPlanner()
+    : finished_runs_(0)
+    , finished_buff_rounds_(0)
+    , total_offers_(0)
+    , buff_rounds_(0) {}
+
+void ResearchPlanner::begin_run() {
+    std::lock_guard lock(lock_);
+    if (buff_rounds_ > 0) {
+        ++finished_runs_;
+        finished_buff_rounds_ += buff_rounds_;
+    }
+    buff_rounds_ = 0;
+    collected_.clear();
+}
+
+QList<int> ResearchPlanner::plan_buff_selection(
+    const QStringList &candidates, int count, const QStringList &preference, Xoshiro256 &rng) {
+    std::lock_guard lock(lock_);
+
+    //! NOTE: ties are broken at random, so buffs out of the preference are still picked uniformly
+    QList<int> order(candidates.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::shuffle(order.begin(), order.end(), rng);
+
+    //! NOTE: pick one by one, so that a buff offered twice loses value once it has been taken
+    auto       collected = collected_;
+    QList<int> choices;
+    while (choices.size() < count && !order.isEmpty()) {
+        int    best    = 0;
+        double best_ev = -1.0;
+        for (int i = 0; i < order.size(); ++i) {
+            const double ev = buff_value(candidates[order[i]], preference, collected);
+            if (ev > best_ev) {
+                best    = i;
+                best_ev = ev;
+            }
+        }
+        const int index = order.takeAt(best);
+        ++collected[candidates[index]];
+        choices.append(index);
+    }
+
+    return choices;
+}
+
+void ResearchPlanner::observe_buff_offer(const QStringList &candidates, const QList<int> &taken) {
+    std::lock_guard lock(lock_);
+    //! NOTE: a single candidate is granted without choice, it is collected but not an offer
+    if (candidates.size() > 1) {
+        ++buff_rounds_;
+        ++total_offers_;
+        for (const auto &name : QSet<QString>(candidates.begin(), candidates.end())) { ++offered_[name]; }
+    }
+    for (const int index : taken) { ++collected_[candidates[index]]; }
+}
+
+int ResearchPlanner::remaining_buff_rounds() const {
+    const int horizon = finished_runs_ > 0 ? std::lround(1.0 * finished_buff_rounds_ / finished_runs_) : DEFAULT_BUFF_ROUNDS;
+    return std::max(horizon - buff_rounds_, 1);
+}
+
+double ResearchPlanner::buff_value(
+    const QString &name, const QStringList &preference, const QMap<QString, int> &collected) const {
+    const int rank = preference.indexOf(name);
+    if (rank == -1) { return 0.0; }
+
+    const double weight = std::pow(STACK_DECAY, collected.value(name)) * (preference.size() - rank) / preference.size();
+
+    //! NOTE: a buff which is likely to be offered again in a later round of the run is worth less now, since the slot
+    //! can go to a rarer one; taking b over c pays off iff w(b) * (1 - q(b)) > w(c) * (1 - q(c)), where q is the chance
+    //! of being offered again
+    const double rate      = offered_.value(name) / (total_offers_ + PRIOR_OFFERS);
+    const double reoffered = 1.0 - std::pow(1.0 - rate, remaining_buff_rounds() - 1);
+    return weight * (1.0 - reoffered);
+}
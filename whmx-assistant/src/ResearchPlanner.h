@@ -0,0 +1,63 @@
+/* Copyright 2024 周上行Ryer
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#pragma once
+
+#include "Random.h"
+
+#include <MaaPP/MaaPP.hpp>
+#include <QtCore/QList>
+#include <QtCore/QMap>
+#include <QtCore/QStringList>
+#include <memory>
+#include <mutex>
+
+//! session-level planner of the research run, it keeps the state across rounds, i.e. the collected buffs and the
+//! remaining rounds, and picks buffs by their expected value over the rest of the run
+//! NOTE: grade changes are left to the static policies of SelectGradeOption, the outcome of a roll is never observed so
+//! there is nothing to learn the value of a grade from
+class ResearchPlanner {
+public:
+    static constexpr int    DEFAULT_BUFF_ROUNDS = 3;   //<! assumed buff selections per run until a run is finished
+    static constexpr double STACK_DECAY         = 0.5; //<! value kept by each extra copy of a collected buff
+    static constexpr double PRIOR_OFFERS        = 4.0; //<! pseudo count which damps the offer rate of rarely seen buffs
+
+    static std::shared_ptr<ResearchPlanner> create();
+
+    //! planner of the device which the context is running on, it is owned by the session and dropped together with it;
+    //! callbacks bound without a session share one planner
+    static std::shared_ptr<ResearchPlanner> of(const maa::SyncContextHandle &context);
+
+    //! start of a new research run, the length of the finished run feeds the horizon of the following runs
+    void begin_run();
+
+    //! indices of the candidates to take, in the order of descending value
+    QList<int> plan_buff_selection(const QStringList &candidates, int count, const QStringList &preference, Xoshiro256 &rng);
+    void       observe_buff_offer(const QStringList &candidates, const QList<int> &taken);
+
+protected:
+    ResearchPlanner();
+
+    int    remaining_buff_rounds() const;
+    double buff_value(const QString &name, const QStringList &preference, const QMap<QString, int> &collected) const;
+
+private:
+    std::mutex         lock_;
+    int                finished_runs_;        //<! across runs
+    int                finished_buff_rounds_; //<! across runs
+    int                total_offers_;         //<! across runs
+    QMap<QString, int> offered_;              //<! across runs, number of offers containing the buff
+    int                buff_rounds_;          //<! current run
+    QMap<QString, int> collected_;            //<! current run
+};
@@ -0,0 +1,42 @@
+/* Copyright 2024 周上行Ryer
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#include "ResultStore.h"
+#include "DeviceSession.h"
+
+ResultStore &ResultStore::instance() {
+    static ResultStore store;
+    return store;
+}
+
+ResultStore::Key ResultStore::make_key(const maa::SyncContextHandle &context, std::string_view task_name) {
+    //! NOTE: the sync context is a fresh wrapper on every callback, only the session stays the same across the
+    //! recognizer and the action, callbacks bound without a session share the null scope
+    const void *scope = DeviceSession::of(context).get();
+    return Key{scope, std::string(task_name)};
+}
+
+void ResultStore::clear(const maa::SyncContextHandle &context, std::string_view task_name) {
+    std::lock_guard lock(lock_);
+    results_.erase(make_key(context, task_name));
+}
+
+void ResultStore::drop_scope(const void *scope) {
+    std::lock_guard lock(lock_);
+    //! NOTE: keys are ordered by the scope first, so the results of a session are contiguous
+    const auto first = results_.lower_bound(Key{scope, std::string()});
+    auto       last  = first;
+    while (last != results_.end() && last->first.first == scope) { ++last; }
+    results_.erase(first, last);
+}
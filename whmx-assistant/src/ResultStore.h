@@ -0,0 +1,69 @@
+/* Copyright 2024 周上行Ryer
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+#pragma once
+
+#include <MaaPP/MaaPP.hpp>
+#include <any>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+//! typed side-channel which hands the result of a custom recognizer over to the custom action of the same task
+//! NOTE: results are keyed by the device session and the task name, within one session the tasks run one after
+//! another, so the key always refers to the current run of the task; rec_detail is still filled for logging and for
+//! the actions which are triggered with a detail from elsewhere
+//! NOTE: a result whose action never runs is cleared by the next run of the same recognizer, and every result of a
+//! session is dropped along with the session, so that neither a later run nor a session at a reused address sees it
+class ResultStore {
+public:
+    static ResultStore &instance();
+
+    template <typename T>
+    void put(const maa::SyncContextHandle &context, std::string_view task_name, T value) {
+        std::lock_guard lock(lock_);
+        results_[make_key(context, task_name)] = std::make_any<T>(std::move(value));
+    }
+
+    //! forget the result of the task, if any
+    void clear(const maa::SyncContextHandle &context, std::string_view task_name);
+    //! drop every result of the session, scope is the raw DeviceSession pointer
+    void drop_scope(const void *scope);
+
+    //! removes the result, std::nullopt if there is none or it is of another type
+    template <typename T>
+    std::optional<T> take(const maa::SyncContextHandle &context, std::string_view task_name) {
+        std::lock_guard lock(lock_);
+        const auto      it = results_.find(make_key(context, task_name));
+        if (it == results_.end()) { return std::nullopt; }
+        std::optional<T> value;
+        if (auto ptr = std::any_cast<T>(&it->second)) { value = std::move(*ptr); }
+        results_.erase(it);
+        return value;
+    }
+
+protected:
+    ResultStore() = default;
+
+private:
+    using Key = std::pair<const void *, std::string>;
+
+    static Key make_key(const maa::SyncContextHandle &context, std::string_view task_name);
+
+    std::mutex              lock_;
+    std::map<Key, std::any> results_;
+};
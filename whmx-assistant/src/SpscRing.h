@@ -0,0 +1,64 @@
+/* Copyright 2024 周上行Ryer
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+//! single-producer single-consumer ring, typically owned by exactly one producer thread
+//! NOTE: consumers must be serialized by the owner of the ring, the producer never takes a lock
+template <typename T, size_t Capacity>
+class SpscRing {
+public:
+    static constexpr size_t CAPACITY = Capacity;
+
+    //! NOTE: the value is only moved from when the push succeeds
+    bool push(T &&value) {
+        const auto tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_.load(std::memory_order_acquire) == CAPACITY) { return false; }
+        slots_[tail % CAPACITY] = std::move(value);
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T &value) {
+        const auto head = head_.load(std::memory_order_relaxed);
+        if (head == tail_.load(std::memory_order_acquire)) { return false; }
+        value = std::move(slots_[head % CAPACITY]);
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool empty() const {
+        return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+    }
+
+    void retire() {
+        retired_.store(true, std::memory_order_release);
+    }
+
+    bool retired() const {
+        return retired_.load(std::memory_order_acquire);
+    }
+
+private:
+    std::array<T, CAPACITY> slots_;
+    alignas(64) std::atomic_size_t head_{0}; //<! next slot to read, owned by the consumer
+    alignas(64) std::atomic_size_t tail_{0}; //<! next slot to write, owned by the producer
+    std::atomic_bool retired_{false};        //<! set once the owner thread has exited
+};
@@ -60,6 +60,17 @@ bool load_task_config(Config& config, const QString& file_path, std::shared_ptr<
         if (!rev_index_table.contains(major_task_name)) { continue; }
         const auto major_task           = rev_index_table.value(major_task_name);
         config.task_entries[major_task] = task_entry;
+        if (binding.contains("budget") && binding.at("budget").is_number()) {
+            config.task_budgets[major_task]  = binding.at("budget").as_integer();
+            config.entry_budgets[task_entry] = binding.at("budget").as_integer();
+        }
+    }
+
+    if (data->contains("budgets") && data->at("budgets").is_object()) {
+        for (const auto& [entry, budget] : data->at("budgets").as_object()) {
+            if (!budget.is_number()) { continue; }
+            config.entry_budgets[QString::fromUtf8(entry)] = budget.as_integer();
+        }
     }
 
     if (router && data->contains("router") && data->at("router").is_object()) {
@@ -29,6 +29,8 @@ class Router;
 struct Config {
     QMap<MajorTask, QString>  task_entries;
     QMap<MajorTask, QVariant> task_params;
+    QMap<MajorTask, int>      task_budgets;  //<! in seconds, the task is stopped by the watchdog once it runs out
+    QMap<QString, int>        entry_budgets; //<! in seconds, budgets of custom tasks keyed by the pipeline entry
 };
 
 void                    reset_shared_task_config(const std::shared_ptr<Config> config);
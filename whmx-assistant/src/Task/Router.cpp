@@ -193,6 +193,7 @@ Router::TaskInfo Router::TaskInfo::parse(const json::object &data) {
         if (data.contains("param")) { task_info.override_task_params = data.at("param").as_object(); }
     }
     if (data.contains("on")) { task_info.trigger_condition = Condition::parse(data.at("on").as_object()); }
+    if (data.contains("budget") && data.at("budget").is_number()) { task_info.budget = data.at("budget").as_integer(); }
     task_info.fold_params = data.get("fold_params", true);
     return task_info;
 }
@@ -437,7 +438,7 @@ std::optional<RouteContext::Task> RouteContext::next() {
                     if (has_unfolded_param_for_entry_task) { unfolded_params.erase(task_name.toStdString()); }
                     task_params |= unfolded_params;
                 }
-                return std::make_optional<Task>({task_name, task_params});
+                return std::make_optional<Task>({task_name, task_params, target_task.budget});
             }
         }
     }
@@ -49,6 +49,7 @@ public:
         std::optional<QString>      task_entry;
         std::optional<json::object> override_task_params;
         std::optional<Condition>    trigger_condition;
+        std::optional<int>          budget; //<! in seconds, overrides the budget of the major task for this step
         bool                        fold_params;
 
         static TaskInfo parse(const json::object &data);
@@ -105,8 +106,9 @@ public:
     };
 
     struct Task {
-        QString      task_entry;
-        json::object params;
+        QString            task_entry;
+        json::object       params;
+        std::optional<int> budget; //<! in seconds
     };
 
 public:
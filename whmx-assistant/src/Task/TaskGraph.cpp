@@ -127,6 +127,34 @@ bool TaskGraph::merge_pipeline(const QString &pipeline_file) {
     return true;
 }
 
+void TaskGraph::remove_pipeline(const QString &pipeline_file) {
+    const int source_nr = sources.indexOf(pipeline_file);
+    if (source_nr == -1) { return; }
+
+    //! NOTE: edges are declared by the pred, so the out edges of the nodes defined in the file are exactly the edges
+    //! contributed by the file
+    for (const auto &node : nodes) {
+        if (node->source_nr != source_nr) { continue; }
+        for (const auto &succ : node->succs) {
+            succ->preds.removeIf([&node](const auto &pred) {
+                return pred == node;
+            });
+        }
+        node->succs.clear();
+        node->source_nr = -1;
+    }
+
+    //! NOTE: nodes still referenced by other pipelines are kept as placeholders, same as a forward reference
+    nodes.removeIf([](const auto &node) {
+        return node->source_nr == -1 && node->preds.empty() && node->succs.empty();
+    });
+}
+
+bool TaskGraph::reload_pipeline(const QString &pipeline_file) {
+    remove_pipeline(pipeline_file);
+    return merge_pipeline(pipeline_file);
+}
+
 QStringList TaskGraph::root_tasks() const {
     QStringList resp;
     for (const auto &node : nodes) {
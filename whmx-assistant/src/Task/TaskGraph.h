@@ -60,6 +60,8 @@ struct TaskGraph {
     void                                          add_edge(const QString &pred_name, const QString &succ_name);
 
     bool        merge_pipeline(const QString &pipeline_file);
+    void        remove_pipeline(const QString &pipeline_file);
+    bool        reload_pipeline(const QString &pipeline_file);
     QStringList root_tasks() const;
     QStringList find_left_root_tasks(const QStringList &exclude_tasks) const;
 };
@@ -0,0 +1,225 @@
+/* Copyright 2024 周上行Ryer
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "Trace.h"
+#include "SpscRing.h"
+#include "Logger.h"
+
+#include <QtCore/QFile>
+#include <QtCore/QDebug>
+#include <meojson/json.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Trace {
+
+using Clock     = std::chrono::steady_clock;
+using TraceRing = SpscRing<Event, 1024>;
+
+static std::atomic_bool TRACE_ENABLED = true;
+
+static int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+}
+
+static uint32_t current_tid() {
+    static std::atomic_uint32_t next_tid = 1;
+    thread_local const uint32_t tid      = next_tid.fetch_add(1);
+    return tid;
+}
+
+namespace {
+struct LocalRing {
+    std::shared_ptr<TraceRing> ring;
+
+    ~LocalRing() {
+        if (ring) { ring->retire(); }
+    }
+};
+
+//! collects the events from the per-thread rings and streams them into the trace file in chunks
+//! NOTE: until a trace file is opened the events are kept in a bounded store, where the oldest ones are dropped
+class Recorder {
+public:
+    static constexpr size_t MAX_EVENTS   = 1 << 16;
+    static constexpr size_t CHUNK_EVENTS = 1 << 12;
+
+    static Recorder &instance() {
+        static Recorder instance;
+        return instance;
+    }
+
+    void record(Event &&event) {
+        auto ring = local_ring();
+        if (ring->push(std::move(event))) { return; }
+        //! NOTE: the owner thread drains its own ring when full, so the lock is taken once per ring capacity and a chunk is
+        //! written once per CHUNK_EVENTS
+        std::lock_guard lock(collect_lock_);
+        collect();
+        ring->push(std::move(event));
+    }
+
+    bool open(const QString &path) {
+        std::lock_guard lock(collect_lock_);
+        if (sink_) { return false; }
+        auto file = std::make_unique<QFile>(path);
+        if (!file->open(QIODevice::WriteOnly | QIODevice::Truncate)) { return false; }
+        file->write("[");
+        sink_      = std::move(file);
+        origin_ns_ = now_ns();
+        first_     = true;
+        written_   = 0;
+        collect();
+        return true;
+    }
+
+    void close() {
+        std::lock_guard lock(collect_lock_);
+        if (!sink_) { return; }
+        collect();
+        write_chunk();
+        sink_->write("]");
+        sink_->close();
+        LOG_INFO() << "exported" << written_ << "trace events to" << sink_->fileName();
+        if (dropped_ > 0) { LOG_WARN() << dropped_ << "trace events were dropped before the trace file was opened"; }
+        sink_.reset();
+    }
+
+protected:
+    TraceRing *local_ring() {
+        thread_local LocalRing local;
+        if (!local.ring) {
+            local.ring = std::make_shared<TraceRing>();
+            std::lock_guard lock(rings_lock_);
+            rings_.push_back(local.ring);
+        }
+        return local.ring.get();
+    }
+
+    //! NOTE: requires collect_lock_
+    void collect() {
+        {
+            std::lock_guard lock(rings_lock_);
+            std::erase_if(rings_, [this](const std::shared_ptr<TraceRing> &ring) {
+                const bool retired = ring->retired();
+                Event      event;
+                while (ring->pop(event)) { events_.push_back(std::move(event)); }
+                return retired && ring->empty();
+            });
+        }
+        if (sink_) {
+            if (events_.size() >= CHUNK_EVENTS) { write_chunk(); }
+        } else if (events_.size() > MAX_EVENTS) {
+            dropped_ += events_.size() - MAX_EVENTS;
+            events_.erase(events_.begin(), events_.end() - MAX_EVENTS);
+        }
+    }
+
+    //! NOTE: requires collect_lock_, events are only ordered within a chunk which the trace viewers do not mind
+    void write_chunk() {
+        std::stable_sort(events_.begin(), events_.end(), [](const Event &lhs, const Event &rhs) {
+            return lhs.begin_ns < rhs.begin_ns;
+        });
+        for (const auto &event : events_) {
+            json::object args;
+            for (int i = 0; i < event.num_attributes; ++i) {
+                const auto &[key, value] = event.attributes[i];
+                std::visit(
+                    [&args, key](const auto &value) {
+                        args[key] = value;
+                    },
+                    value);
+            }
+
+            const json::object entry{
+                {"name", event.name                         },
+                {"cat",  event.category                     },
+                {"ph",   "X"                                },
+                {"ts",   (event.begin_ns - origin_ns_) / 1e3},
+                {"dur",  event.duration_ns / 1e3            },
+                {"pid",  1                                  },
+                {"tid",  event.tid                          },
+                {"args", args                               },
+            };
+            if (!first_) { sink_->write(",\n"); }
+            sink_->write(entry.to_string().c_str());
+            first_ = false;
+        }
+        written_ += events_.size();
+        events_.clear();
+        sink_->flush();
+    }
+
+private:
+    std::mutex                              rings_lock_;
+    std::vector<std::shared_ptr<TraceRing>> rings_;
+    std::mutex                              collect_lock_;
+    std::deque<Event>                       events_;
+    std::unique_ptr<QFile>                  sink_;
+    int64_t                                 origin_ns_ = 0;
+    bool                                    first_     = true;
+    size_t                                  written_   = 0;
+    size_t                                  dropped_   = 0; //<! before the trace file is opened
+};
+} // namespace
+
+void set_enabled(bool on) {
+    TRACE_ENABLED.store(on, std::memory_order_relaxed);
+}
+
+bool enabled() {
+    return TRACE_ENABLED.load(std::memory_order_relaxed);
+}
+
+bool start_chrome_trace(const QString &path) {
+    if (!Recorder::instance().open(path)) {
+        LOG_WARN() << "failed to open trace file" << path;
+        return false;
+    }
+    return true;
+}
+
+void finish_chrome_trace() {
+    Recorder::instance().close();
+}
+
+Span::Span(const char *category, std::string_view name)
+    : active_(enabled()) {
+    if (!active_) { return; }
+    event_.category       = category;
+    event_.name           = std::string(name);
+    event_.tid            = current_tid();
+    event_.num_attributes = 0;
+    event_.begin_ns       = now_ns();
+}
+
+Span::~Span() {
+    if (!active_) { return; }
+    event_.duration_ns = now_ns() - event_.begin_ns;
+    Recorder::instance().record(std::move(event_));
+}
+
+Span &Span::put(const char *key, AttributeValue value) {
+    if (!active_ || event_.num_attributes >= Event::MAX_ATTRIBUTES) { return *this; }
+    event_.attributes[event_.num_attributes++] = Attribute{key, std::move(value)};
+    return *this;
+}
+
+} // namespace Trace
@@ -0,0 +1,93 @@
+/* Copyright 2024 周上行Ryer
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include "MacroHelper.h"
+
+#include <QtCore/QString>
+#include <array>
+#include <concepts>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <variant>
+
+#define TRACE_SCOPE(category, name) const ::Trace::Span MH_CONCAT(trace_span_, __LINE__)(category, name)
+
+namespace Trace {
+
+using AttributeValue = std::variant<int64_t, double, std::string>;
+
+struct Attribute {
+    const char    *key; //<! string literal
+    AttributeValue value;
+};
+
+struct Event {
+    static constexpr int MAX_ATTRIBUTES = 4;
+
+    const char                           *category;    //<! string literal
+    std::string                           name;
+    uint32_t                              tid;         //<! compact thread id, assigned in order of the first span
+    int64_t                               begin_ns;    //<! steady clock
+    int64_t                               duration_ns;
+    std::array<Attribute, MAX_ATTRIBUTES> attributes;
+    int                                   num_attributes;
+};
+
+void set_enabled(bool on);
+bool enabled();
+
+//! stream the events into a chrome trace json file, which can be loaded into chrome://tracing or perfetto
+//! NOTE: events are written in chunks as they are collected, and the file is left in the json array format whose closing
+//! bracket is optional, so that a crashed session still leaves a loadable trace behind
+bool start_chrome_trace(const QString &path);
+//! write the pending events and close the trace file
+void finish_chrome_trace();
+
+//! scoped span which records a complete event into the buffer of the current thread when it leaves the scope
+//! NOTE: spans are cheap enough to be left in hot paths, a disabled span only costs a flag check
+class Span {
+public:
+    Span(const char *category, std::string_view name);
+    ~Span();
+
+    Span(const Span &)            = delete;
+    Span &operator=(const Span &) = delete;
+
+    //! attributes beyond Event::MAX_ATTRIBUTES are ignored
+    Span &attr(const char *key, std::integral auto value) {
+        return put(key, static_cast<int64_t>(value));
+    }
+
+    Span &attr(const char *key, std::floating_point auto value) {
+        return put(key, static_cast<double>(value));
+    }
+
+    Span &attr(const char *key, std::string_view value) {
+        if (!active_) { return *this; }
+        return put(key, std::string(value));
+    }
+
+protected:
+    Span &put(const char *key, AttributeValue value);
+
+private:
+    bool  active_;
+    Event event_;
+};
+
+} // namespace Trace
@@ -18,8 +18,13 @@
 #include "TaskConfigPanel.h"
 #include "../App.h"
 #include "../Logger.h"
+#include "../Trace.h"
+#include "../Metrics.h"
+#include "../MetricsServer.h"
+#include "../Watchdog.h"
 #include "../Rec/Research.h"
 #include "../Rec/Utils.h"
+#include "../Rec/TemplateMatch.h"
 #include "../Action/Research.h"
 #include "../Action/FourInRow.h"
 #include "../Action/Combat.h"
@@ -33,12 +38,47 @@
 #include <magic_enum.hpp>
 #include <chrono>
 #include <spdlog/spdlog.h>
+#include <spdlog/async.h>
 #include <spdlog/sinks/basic_file_sink.h>
 
 using namespace maa;
 
+using Clock = std::chrono::steady_clock;
+
 namespace UI {
 
+//! record the duration and the outcome of a pipeline task under the metric family prefix
+static void record_task_metrics(const std::string &prefix, const std::string &task, Clock::time_point since, int status) {
+    auto                 &registry = Metrics::Registry::instance();
+    const Metrics::Labels labels{{"task", task}};
+    const auto            elapsed = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - since);
+    registry.histogram(prefix + "_duration_seconds", labels).record(elapsed.count());
+    if (status != MaaStatus_Success) { registry.counter(prefix + "_failures_total", labels).inc(); }
+}
+
+//! guard a pipeline task with the watchdog, the instance is only stopped when a budget is explicitly configured
+//! NOTE: tasks without a budget may legitimately run for long, so they are only reported once the default budget is used up
+static WatchdogGuard guard_task(
+    std::shared_ptr<Instance> instance, QString task_name, std::optional<std::chrono::milliseconds> budget) {
+    if (!budget.has_value()) {
+        return WatchdogGuard(Watchdog::DEFAULT_BUDGET, [task_name] {
+            LOG_WARN().noquote() << "task" << task_name << "is still running after the default budget";
+            LOG_WARN(Workstation).noquote() << QString("任务 %1 运行时间较长，请确认其是否正常").arg(task_name);
+        });
+    }
+    return WatchdogGuard(budget.value(), [instance, task_name] {
+        LOG_WARN().noquote() << "task" << task_name << "exceeded its budget, stop the instance";
+        LOG_WARN(Workstation).noquote() << QString("任务 %1 超出时限，已强制终止").arg(task_name);
+        instance->stop();
+    });
+}
+
+//! budget in seconds from the task config
+static std::optional<std::chrono::milliseconds> budget_of(std::optional<int> seconds) {
+    if (!seconds.has_value() || seconds.value() <= 0) { return std::nullopt; }
+    return std::chrono::seconds(seconds.value());
+}
+
 void Client::reload_anecdotes() {
     const auto anecdotes_path = data_dir() + "/anecdotes.json";
     auto       anecdote_set   = Ref::ResearchAnecdoteSet::instance();
@@ -90,7 +130,7 @@ void Client::build_task_graph() {
 
     QStringList pipeline_files;
     for (const auto &dir : pipeline_dirs) {
-        for (const auto &entry : dir.entryList({"*.json"})) { pipeline_files.append(dir.filePath(entry)); }
+        for (const auto &entry : dir.entryList({"*.json"})) { pipeline_files.append(QDir::cleanPath(dir.filePath(entry))); }
     }
 
     task_graph_->nodes.clear();
@@ -110,7 +150,10 @@ void Client::setup_runtime_log() {
     const auto log_path      = QString("%1/runtime.%2.log").arg(log_dir()).arg(datetime.toString("yyyyMMddHH"));
     latest_runtime_log_file_ = log_path;
 
-    auto runtime_logger = spdlog::basic_logger_mt("whmx-assistant.default", log_path.toLocal8Bit().toStdString());
+    //! NOTE: records are already batched by the logger backend, the spdlog thread pool only takes over the file io
+    spdlog::init_thread_pool(8192, 1);
+    auto runtime_logger = spdlog::create_async<spdlog::sinks::basic_file_sink_mt>(
+        "whmx-assistant.default", log_path.toLocal8Bit().toStdString());
     runtime_logger->set_pattern("%Y-%m-%d %H:%M:%S.%e [%l] %v");
 
     //! TODO: enable level config
@@ -161,12 +204,63 @@ void Client::handle_on_reload_assets() {
     reload_anecdotes();
     reload_task_config();
     build_task_graph();
+    sync_res_dir();
+}
 
-    if (maa_res_ && (!fut_res_req_path_.state_->task_.has_value() || fut_res_req_path_.fulfilled())) {
-        fut_res_req_path_ = coro::EventLoop::current()->eval([this, assets_dir = assets_dir().toStdString()] {
-            LOG_INFO().noquote() << "sync res dir:" << assets_dir;
-            emit on_sync_res_dir_done(maa_res_->post_path(assets_dir)->wait().sync_wait());
-        });
+void Client::sync_res_dir() {
+    if (!maa_res_) { return; }
+    //! NOTE: a request during an in-flight sync is not dropped, it is replayed once the current sync is done
+    if (res_dir_syncing_) {
+        res_dir_dirty_ = true;
+        return;
+    }
+    res_dir_syncing_  = true;
+    fut_res_req_path_ = coro::EventLoop::current()->eval([this, assets_dir = assets_dir().toStdString()] {
+        LOG_INFO().noquote() << "sync res dir:" << assets_dir;
+        Rec::TemplateMatch::TemplateCache::instance().reset(assets_dir + "/image");
+        emit on_sync_res_dir_done(maa_res_->post_path(assets_dir)->wait().sync_wait());
+    });
+}
+
+void Client::handle_on_assets_changed(const QStringList &changed_files, const QStringList &removed_files) {
+    const auto pipeline_dir     = QDir::cleanPath(assets_dir() + "/pipeline");
+    const auto anecdotes_path   = QDir::cleanPath(data_dir() + "/anecdotes.json");
+    const auto task_config_path = QDir::cleanPath(data_dir() + "/task_bindings.json");
+
+    const auto is_pipeline = [&pipeline_dir](const QString &file) {
+        return file.startsWith(pipeline_dir + '/') && file.endsWith(".json");
+    };
+
+    bool pipeline_changed    = false;
+    bool task_config_changed = false;
+
+    for (const auto &file : removed_files) {
+        if (!is_pipeline(file)) { continue; }
+        task_graph_->remove_pipeline(file);
+        pipeline_changed = true;
+    }
+
+    //! NOTE: only the changed pipelines are re-merged into the task graph, data files are re-parsed one by one
+    for (const auto &file : changed_files) {
+        if (false) {
+        } else if (file == anecdotes_path) {
+            reload_anecdotes();
+        } else if (file == task_config_path) {
+            reload_task_config();
+            task_config_changed = true;
+        } else if (is_pipeline(file)) {
+            if (!task_graph_->reload_pipeline(file)) { LOG_WARN().noquote() << "failed to reload pipeline" << file; }
+            pipeline_changed = true;
+        }
+    }
+
+    if (pipeline_changed) {
+        //! NOTE: maa resource can only be loaded as a whole, task list is refreshed once the sync is done
+        LOG_INFO(Workstation) << "检测到流水线变更，已重新载入";
+        sync_res_dir();
+    } else if (task_config_changed) {
+        QStringList major_tasks_bindings(task_config_->task_entries.values());
+        emit gApp->app_event()->workbench_on_reload_pipeline_tasks(task_graph_->find_left_root_tasks(major_tasks_bindings));
     }
 }
 
@@ -189,6 +283,14 @@ void Client::handle_on_open_log_file(LogFileType type) {
 }
 
 void Client::handle_on_sync_res_dir_done(int maa_status) {
+    res_dir_syncing_ = false;
+    if (res_dir_dirty_) {
+        res_dir_dirty_ = false;
+        LOG_INFO() << "assets changed during the sync, sync res dir again";
+        sync_res_dir();
+        return;
+    }
+
     if (maa_status != MaaStatus_Success) {
         LOG_ERROR() << "failed to sync res dir";
         LOG_ERROR(Workstation) << "MAA 资源加载失败，请检查本地资源完整性 [assets/general]";
@@ -200,38 +302,104 @@ void Client::handle_on_sync_res_dir_done(int maa_status) {
     }
 }
 
-void Client::execute_pipeline_task(QString task_id, QVariant task) {
-    Q_ASSERT(maa_instance_ && maa_instance_->inited());
+std::shared_ptr<Client::Device> Client::find_device(const std::string &address) const {
+    for (const auto &device : devices_) {
+        if (device->address == address) { return device; }
+    }
+    return nullptr;
+}
 
-    emit gApp->app_event()->workbench_on_notify_queued_task_accepted(task_id);
+std::shared_ptr<Client::Device> Client::pick_device() const {
+    std::shared_ptr<Device> picked;
+    qsizetype               least_load = 0;
+    for (const auto &device : devices_) {
+        if (!device->session) { continue; }
+        const auto load = device->pending_tasks.size() + (device->busy ? 1 : 0);
+        if (!picked || load < least_load) {
+            picked     = device;
+            least_load = load;
+        }
+    }
+    return picked;
+}
+
+void Client::run_next_device_task(std::shared_ptr<Device> device) {
+    if (device->busy || device->pending_tasks.empty()) { return; }
+    device->busy = true;
 
-    if (const QString type_name = task.typeName(); type_name == "Task::MajorTask") {
-        execute_major_task(task_id, task.value<Task::MajorTask>());
+    const auto queued_task = device->pending_tasks.dequeue();
+    LOG_INFO().noquote() << "run task" << queued_task.task_id << "on device" << QString::fromStdString(device->address);
+
+    if (const QString type_name = queued_task.task.typeName(); type_name == "Task::MajorTask") {
+        execute_major_task(device, queued_task.task_id, queued_task.task.value<Task::MajorTask>());
     } else if (type_name == "QString") {
-        execute_custom_task(task_id, task.value<QString>());
+        execute_custom_task(device, queued_task.task_id, queued_task.task.value<QString>());
     } else {
         std::unreachable();
     }
 }
 
-void Client::execute_major_task(const QString &task_id, Task::MajorTask task) {
+void Client::finish_device_task(std::shared_ptr<Device> device, const QString &task_id, int status) {
+    //! NOTE: device queues are only touched on the client thread, and the finish is only announced once the device has
+    //! been released, otherwise the task pushed in response would still see the device busy and queue up behind it
+    QMetaObject::invokeMethod(
+        this,
+        [this, device, task_id, status] {
+            device->busy = false;
+            run_next_device_task(device);
+            emit gApp->app_event()->workbench_on_notify_queued_task_finished(task_id, status);
+        },
+        Qt::QueuedConnection);
+}
+
+void Client::handle_on_stop_pipeline() {
+    //! NOTE: the running task of each device is stopped by the workbench, only the queued ones are dropped here
+    for (const auto &device : devices_) {
+        if (device->pending_tasks.empty()) { continue; }
+        LOG_INFO().noquote() << "drop" << device->pending_tasks.size() << "queued tasks on device"
+                             << QString::fromStdString(device->address);
+        device->pending_tasks.clear();
+    }
+}
+
+void Client::execute_pipeline_task(QString task_id, QVariant task) {
+    //! NOTE: the least loaded device takes the task, tasks on the same device are executed in order
+    const auto device = pick_device();
+    if (!device) {
+        LOG_WARN().noquote() << "reject task" << task_id << ": no connected device";
+        return;
+    }
+
+    emit gApp->app_event()->workbench_on_notify_queued_task_accepted(task_id);
+
+    device->pending_tasks.enqueue(QueuedTask{task_id, task});
+    run_next_device_task(device);
+}
+
+void Client::execute_major_task(std::shared_ptr<Device> device, const QString &task_id, Task::MajorTask task) {
     const auto major_task_name = Task::get_task_info(task).name;
     if (task_config_->task_entries.contains(task)) {
         //! TODO: pass major task params
         const auto task_entry = task_config_->task_entries.value(task);
-        coro::EventLoop::current()->eval([this, task, task_id, task_entry, major_task_name] {
+        const auto budget     = task_budget(task);
+        coro::EventLoop::current()->eval([this, device, task_id, task_entry, major_task_name, budget] {
+            Trace::Span span("task", major_task_name.toStdString());
+            span.attr("task_id", task_id.toStdString()).attr("device", device->address);
             LOG_INFO(Workstation).noquote() << QString("启动核心任务 %1 | 目标任务 %2").arg(major_task_name).arg(task_entry);
-            auto flag = std::make_shared<std::atomic_bool>(false);
-            QTimer::singleShot(6e+4 * 5, [expected = flag->load(), flag] {
-                if (expected == *flag) { LOG_WARN(Workstation).noquote() << "超时预警，请检查任务是否进入死循环"; }
-            });
-            const auto status = instance()->post_task(task_entry.toUtf8().toStdString())->wait().sync_wait();
-            flag->store(true);
-            emit gApp->app_event()->workbench_on_notify_queued_task_finished(task_id, status);
+            const auto          instance = device->session->instance();
+            const auto          watchdog = guard_task(instance, major_task_name, budget);
+            const auto          since    = Clock::now();
+            const auto          status   = instance->post_task(task_entry.toUtf8().toStdString())->wait().sync_wait();
+            record_task_metrics("whmx_major_task", major_task_name.toStdString(), since, status);
+            finish_device_task(device, task_id, status);
         });
     } else if (task_router_->contains_route_of(task)) {
-        coro::EventLoop::current()->eval([this, task, task_id, route = task_router_->route(task), major_task_name] {
-            int status = MaaStatus_Invalid;
+        const auto budget = task_budget(task);
+        coro::EventLoop::current()->eval([this, device, task_id, route = task_router_->route(task), major_task_name, budget] {
+            Trace::Span span("task", major_task_name.toStdString());
+            span.attr("task_id", task_id.toStdString()).attr("device", device->address);
+            const auto since  = Clock::now();
+            int        status = MaaStatus_Invalid;
             do {
                 const bool started = route->start();
                 if (started) {
@@ -243,7 +411,7 @@ void Client::execute_major_task(const QString &task_id, Task::MajorTask task) {
                     break;
                 }
                 LOG_TRACE().noquote() << "start route of" << task_id;
-                auto step_index = std::make_shared<int>(0);
+                int step_index = 0;
                 while (route->has_next()) {
                     // if (ui_workbench_->pipeline_state().is_idle()) {
                     //     status = MaaStatus_Success;
@@ -255,19 +423,21 @@ void Client::execute_major_task(const QString &task_id, Task::MajorTask task) {
                         break;
                     }
                     //! NOTE: not exactly correspoding to the real pipeline stage
-                    ++*step_index;
+                    ++step_index;
                     const auto task       = opt_task.value();
                     const auto task_entry = task.task_entry.toUtf8().toStdString();
                     LOG_TRACE().noquote() << "execute task" << task_entry << "with params"
                                           << QString::fromUtf8(task.params.to_string());
                     LOG_INFO(Workstation).noquote()
                         << QString("• 步骤 %1 - %2").arg(route->next_stage()).arg(QString::fromUtf8(task_entry));
-                    QTimer::singleShot(6e+4 * 5, [expected = *step_index, step_index] {
-                        if (expected == *step_index) {
-                            LOG_WARN(Workstation).noquote() << "超时预警，请检查任务是否进入死循环";
-                        }
-                    });
-                    const int task_status = instance()->post_task(task_entry, task.params)->wait().sync_wait();
+                    Trace::Span step_span("route", task_entry);
+                    step_span.attr("step", step_index);
+                    const auto          instance    = device->session->instance();
+                    const auto          step_budget = task.budget.has_value() ? budget_of(task.budget) : budget;
+                    const auto          watchdog    = guard_task(instance, QString::fromUtf8(task_entry), step_budget);
+                    const auto          step_since  = Clock::now();
+                    const int           task_status = instance->post_task(task_entry, task.params)->wait().sync_wait();
+                    record_task_metrics("whmx_pipeline_task", task_entry, step_since, task_status);
                     if (task_status != MaaStatus_Success) {
                         status = task_status;
                         break;
@@ -275,84 +445,112 @@ void Client::execute_major_task(const QString &task_id, Task::MajorTask task) {
                 }
             } while (0);
             if (status == MaaStatus_Invalid) { status = MaaStatus_Success; }
-            emit gApp->app_event()->workbench_on_notify_queued_task_finished(task_id, status);
+            record_task_metrics("whmx_major_task", major_task_name.toStdString(), since, status);
+            finish_device_task(device, task_id, status);
         });
     } else {
         LOG_WARN().noquote() << "failed to execute task" << task_id << ": task entry not found for major task"
                              << magic_enum::enum_name(task);
         LOG_WARN(Workstation).noquote() << QString("未找到 %1 的任务绑定，已跳过").arg(major_task_name);
-        emit gApp->app_event()->workbench_on_notify_queued_task_finished(task_id, MaaStatus_Invalid);
+        finish_device_task(device, task_id, MaaStatus_Invalid);
     }
 }
 
-void Client::execute_custom_task(const QString &task_id, const QString &task_name) {
-    coro::EventLoop::current()->eval([this, task_id, task_entry = task_name] {
+std::optional<std::chrono::milliseconds> Client::task_budget(Task::MajorTask task) const {
+    if (!task_config_->task_budgets.contains(task)) { return std::nullopt; }
+    return budget_of(task_config_->task_budgets.value(task));
+}
+
+std::optional<std::chrono::milliseconds> Client::task_budget(const QString &task_entry) const {
+    if (!task_config_->entry_budgets.contains(task_entry)) { return std::nullopt; }
+    return budget_of(task_config_->entry_budgets.value(task_entry));
+}
+
+void Client::execute_custom_task(std::shared_ptr<Device> device, const QString &task_id, const QString &task_name) {
+    const auto budget = task_budget(task_name);
+    coro::EventLoop::current()->eval([this, device, task_id, task_entry = task_name, budget] {
+        Trace::Span span("task", task_entry.toStdString());
+        span.attr("task_id", task_id.toStdString()).attr("device", device->address);
         LOG_INFO(Workstation).noquote() << QString("执行任务 %1").arg(task_entry);
-        auto flag = std::make_shared<std::atomic_bool>(false);
-        QTimer::singleShot(6e+4 * 5, [expected = flag->load(), flag] {
-            if (expected == *flag) { LOG_WARN(Workstation).noquote() << "超时预警，请检查任务是否进入死循环"; }
-        });
-        const auto status = instance()->post_task(task_entry.toUtf8().toStdString())->wait().sync_wait();
-        flag->store(true);
-        emit gApp->app_event()->workbench_on_notify_queued_task_finished(task_id, status);
+        const auto          instance = device->session->instance();
+        const auto          watchdog = guard_task(instance, task_entry, budget);
+        const auto          since    = Clock::now();
+        const auto          status   = instance->post_task(task_entry.toUtf8().toStdString())->wait().sync_wait();
+        record_task_metrics("whmx_pipeline_task", task_entry.toStdString(), since, status);
+        finish_device_task(device, task_id, status);
     });
 }
 
 void Client::handle_on_request_connect_device(MaaAdbDevice device) {
-    if (maa_ctrl_ && maa_instance_ && maa_instance_->inited()) {
-        Notification::warning(gApp->window_cref(), "设备连接", "不支持多设备连接，已取消该次连接请求");
+    const auto address = device.address.toStdString();
+    const auto known   = find_device(address);
+    if (known && known->session) {
+        Notification::warning(gApp->window_cref(), "设备连接", "该设备已连接，已取消该次连接请求");
         emit on_request_connect_device_done(MaaStatus_Failed);
-    } else if (maa_ctrl_) {
+    } else if (known && !known->fut_conn.fulfilled()) {
+        Notification::warning(gApp->window_cref(), "设备连接", "该设备正在连接中，已取消该次连接请求");
+        emit on_request_connect_device_done(MaaStatus_Failed);
+    } else if (known) {
         LOG_INFO() << "device alreay connected, retry init maa instance";
-        QMetaObject::invokeMethod(this, "handle_on_create_and_init_instance", Qt::AutoConnection);
+        create_and_init_instance(known);
         emit on_request_connect_device_done(MaaStatus_Failed);
     } else {
         AdbDevice adb_device{
             .name     = device.name.toStdString(),
             .adb_path = device.path.toStdString(),
-            .address  = device.address.toStdString(),
+            .address  = address,
             .type     = device.type,
             .config   = device.config.toStdString(),
         };
-        maa_ctrl_ = Controller::make(adb_device, agents_dir().toStdString())
-                        ->set_long_side(1280)
-                        ->set_short_side(720)
-                        ->set_start_entry(Consts::ACTIVITY)
-                        ->set_stop_entry(Consts::PACKAGE);
-        fut_ctrl_req_conn_ = coro::EventLoop::current()->eval([this] {
-            const int maa_status = maa_ctrl_->post_connect()->wait().sync_wait();
-            emit on_request_connect_device_done(maa_ctrl_->post_connect()->wait().sync_wait());
-            if (maa_status != MaaStatus_Success) {
-                maa_ctrl_.reset();
-            } else {
-                QMetaObject::invokeMethod(this, "handle_on_create_and_init_instance", Qt::AutoConnection);
-            }
+        auto conn     = std::make_shared<Device>();
+        conn->address = address;
+        conn->ctrl    = Controller::make(adb_device, agents_dir().toStdString())
+                         ->set_long_side(1280)
+                         ->set_short_side(720)
+                         ->set_start_entry(Consts::ACTIVITY)
+                         ->set_stop_entry(Consts::PACKAGE);
+        devices_.append(conn);
+        conn->fut_conn = coro::EventLoop::current()->eval([this, conn] {
+            const int maa_status = conn->ctrl->post_connect()->wait().sync_wait();
+            emit on_request_connect_device_done(maa_status);
+            QMetaObject::invokeMethod(
+                this,
+                [this, conn, maa_status] {
+                    if (maa_status != MaaStatus_Success) {
+                        devices_.removeOne(conn);
+                    } else {
+                        create_and_init_instance(conn);
+                    }
+                },
+                Qt::QueuedConnection);
         });
     }
 }
 
-void Client::handle_on_create_and_init_instance() {
-    if (maa_instance_ && maa_instance_->inited()) { return; }
+void Client::create_and_init_instance(std::shared_ptr<Device> device) {
+    if (device->session) { return; }
     //! FIXME: ensure maa_res_ is initialized
-    maa_instance_ = Instance::make()->bind(maa_res_)->bind(maa_ctrl_);
-    if (!maa_instance_->inited()) {
-        maa_instance_.reset();
+    //! NOTE: every device gets its own instance on the shared resource
+    auto session = DeviceSession::create(device->address, device->ctrl, maa_res_);
+    if (!session) {
         LOG_ERROR() << "failed to init maa, view log file for details or check your assets integrity";
         return;
     }
-    maa_instance_->bind<Rec::Utils::TwoStageTest>();
-    maa_instance_->bind<Rec::Research::ParseGradeOptionsOnModify>();
-    maa_instance_->bind<Rec::Research::ParseAnecdote>();
-    maa_instance_->bind<Rec::Research::AnalyzeItemPairs>();
-    maa_instance_->bind<Rec::Research::GetCandidateBuffs>();
-    maa_instance_->bind<Action::Research::SelectGradeOption>();
-    maa_instance_->bind<Action::Research::ResolveAnecdote>();
-    maa_instance_->bind<Action::Research::PerformItemPairsMatch>();
-    maa_instance_->bind<Action::Research::ResolveBuffSelection>();
-    maa_instance_->bind<Action::SolveFourInRow>();
-    maa_instance_->bind<Action::Combat::FillSquad>();
-    LOG_INFO() << "maa instance created and initialized";
-    emit gApp->app_event()->workbench_on_accept_maa_instance(maa_instance_);
+    session->bind<Rec::Utils::TwoStageTest>();
+    session->bind<Rec::Research::ParseGradeOptionsOnModify>();
+    session->bind<Rec::Research::ParseAnecdote>();
+    session->bind<Rec::Research::AnalyzeItemPairs>();
+    session->bind<Rec::Research::GetCandidateBuffs>();
+    session->bind<Action::Research::SelectGradeOption>();
+    session->bind<Action::Research::ResolveAnecdote>();
+    session->bind<Action::Research::PerformItemPairsMatch>();
+    session->bind<Action::Research::BeginRun>();
+    session->bind<Action::Research::ResolveBuffSelection>();
+    session->bind<Action::SolveFourInRow>();
+    session->bind<Action::Combat::FillSquad>();
+    device->session = session;
+    LOG_INFO().noquote() << "maa instance created and initialized for device" << QString::fromStdString(device->address);
+    emit gApp->app_event()->workbench_on_accept_maa_instance(session->instance());
 }
 
 Client::Client(const QString &user_path, QObject *parent)
@@ -360,15 +558,28 @@ Client::Client(const QString &user_path, QObject *parent)
     , user_path_(QDir::isAbsolutePath(user_path) ? user_path : app_dir() + "/" + user_path)
     , task_config_(std::make_shared<Task::Config>())
     , task_graph_(std::make_shared<Task::TaskGraph>())
-    , task_router_(std::make_shared<Task::Router>(task_config_, task_graph_)) {
+    , task_router_(std::make_shared<Task::Router>(task_config_, task_graph_))
+    , asset_watcher_(new AssetWatcher(this))
+    , metrics_server_(new MetricsServer(this)) {
     setup();
     config_maa();
+    asset_watcher_->watch(assets_dir() + "/pipeline");
+    asset_watcher_->watch(data_dir());
     setup_runtime_log();
+    const auto datetime = QDateTime::currentDateTime();
+    Trace::start_chrome_trace(QString("%1/trace.%2.json").arg(log_dir()).arg(datetime.toString("yyyyMMddHHmm")));
+    metrics_server_->listen();
     Task::reset_shared_task_config(task_config_);
 }
 
 Client::~Client() {
     //! TODO: dump user config
+    const auto datetime = QDateTime::currentDateTime();
+    Trace::finish_chrome_trace();
+    Metrics::Registry::instance().dump(QString("%1/metrics.%2.prom").arg(log_dir()).arg(datetime.toString("yyyyMMddHHmm")));
+    for (const auto &device : devices_) {
+        if (device->session) { device->session->stop(); }
+    }
 }
 
 void Client::setup() {
@@ -378,9 +589,11 @@ void Client::setup() {
     connect(this, &Client::on_request_connect_device_done, event, &AppEvent::device_conn_on_request_connect_device_done);
     connect(event, &AppEvent::client_on_request_connect_device, this, &Client::handle_on_request_connect_device);
     connect(event, &AppEvent::workbench_on_reload_assets, this, &Client::handle_on_reload_assets);
+    connect(asset_watcher_, &AssetWatcher::on_assets_changed, this, &Client::handle_on_assets_changed);
     connect(event, &AppEvent::workbench_on_open_maa_log_file, this, &Client::handle_on_open_maa_log_file);
     connect(event, &AppEvent::workbench_on_open_app_log_file, this, &Client::handle_on_open_app_log_file);
     connect(event, &AppEvent::workbench_on_post_queued_task, this, &Client::execute_pipeline_task);
+    connect(event, &AppEvent::workbench_on_stop_pipeline, this, &Client::handle_on_stop_pipeline);
     connect(event, &AppEvent::workbench_on_request_open_task_config_panel, this, &Client::create_task_config_panel);
 }
 
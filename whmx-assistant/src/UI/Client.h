@@ -19,11 +19,15 @@
 #include "../Task/TaskGraph.h"
 #include "../Task/Config.h"
 #include "../Task/Router.h"
+#include "../DeviceSession.h"
+#include "../AssetWatcher.h"
+#include "../MetricsServer.h"
 
 #include <MaaPP/MaaPP.hpp>
 #include <QtWidgets/QTabWidget>
 #include <QtWidgets/QApplication>
 #include <QtCore/QDateTime>
+#include <QtCore/QQueue>
 
 namespace UI {
 
@@ -65,30 +69,51 @@ public:
         return user_dir() + "/agents";
     }
 
-    std::shared_ptr<maa::Controller> controller() const {
-        return maa_ctrl_;
-    }
-
     std::shared_ptr<maa::Resource> resource() const {
         return maa_res_;
     }
 
-    std::shared_ptr<maa::Instance> instance() const {
-        return maa_instance_;
-    }
-
     void reload_anecdotes();
     void reload_task_config();
     void build_task_graph();
+    void sync_res_dir();
 
 protected:
+    struct QueuedTask {
+        QString  task_id;
+        QVariant task;
+    };
+
+    struct Device {
+        std::string                      address;
+        std::shared_ptr<maa::Controller> ctrl;
+        std::shared_ptr<DeviceSession>   session;
+        QQueue<QueuedTask>               pending_tasks; //<! per-device task queue, run one by one
+        bool                             busy = false;
+        maa::coro::Promise<void>         fut_conn;
+    };
+
     void setup_runtime_log();
     void config_maa();
 
+    std::shared_ptr<Device> find_device(const std::string &address) const;
+    std::shared_ptr<Device> pick_device() const;
+    void                    create_and_init_instance(std::shared_ptr<Device> device);
+    void                    run_next_device_task(std::shared_ptr<Device> device);
+    void                    finish_device_task(std::shared_ptr<Device> device, const QString &task_id, int status);
+
+    void execute_major_task(std::shared_ptr<Device> device, const QString &task_id, Task::MajorTask task);
+    void execute_custom_task(std::shared_ptr<Device> device, const QString &task_id, const QString &task_name);
+
+    std::optional<std::chrono::milliseconds> task_budget(Task::MajorTask task) const;
+    std::optional<std::chrono::milliseconds> task_budget(const QString &task_entry) const;
+
 public slots:
     void create_task_config_panel(Task::MajorTask task);
 
     void handle_on_reload_assets();
+    void handle_on_stop_pipeline();
+    void handle_on_assets_changed(const QStringList &changed_files, const QStringList &removed_files);
     void handle_on_open_log_file(LogFileType type);
 
     void handle_on_open_maa_log_file() {
@@ -101,12 +126,9 @@ public slots:
 
 protected slots:
     void execute_pipeline_task(QString task_id, QVariant task);
-    void execute_major_task(const QString &task_id, Task::MajorTask task);
-    void execute_custom_task(const QString &task_id, const QString &task_name);
 
     void handle_on_sync_res_dir_done(int maa_status);
     void handle_on_request_connect_device(MaaAdbDevice device);
-    void handle_on_create_and_init_instance();
 
 signals:
     void on_sync_res_dir_done(int maa_status);
@@ -125,11 +147,13 @@ private:
     std::shared_ptr<Task::Config>    task_config_;
     std::shared_ptr<Task::TaskGraph> task_graph_;
     std::shared_ptr<Task::Router>    task_router_;
-    std::shared_ptr<maa::Controller> maa_ctrl_;
     std::shared_ptr<maa::Resource>   maa_res_;
-    std::shared_ptr<maa::Instance>   maa_instance_;
+    QList<std::shared_ptr<Device>>   devices_;
+    AssetWatcher                    *asset_watcher_;
+    MetricsServer                   *metrics_server_;
     maa::coro::Promise<void>         fut_res_req_path_;
-    maa::coro::Promise<void>         fut_ctrl_req_conn_;
+    bool                             res_dir_syncing_ = false;
+    bool                             res_dir_dirty_   = false; //<! a sync is requested while another one is in flight
 };
 
 } // namespace UI
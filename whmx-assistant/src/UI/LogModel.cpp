@@ -0,0 +1,122 @@
+/* Copyright 2024 周上行Ryer
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "LogModel.h"
+
+#include <algorithm>
+
+namespace UI {
+
+int LogModel::capacity() const {
+    return capacity_;
+}
+
+void LogModel::set_capacity(int capacity) {
+    capacity = std::max(capacity, 0);
+    if (capacity == capacity_) { return; }
+
+    beginResetModel();
+    const auto kept = lines().mid(std::max<qsizetype>(size_ - capacity, 0));
+    ring_           = kept;
+    head_           = 0;
+    size_           = kept.size();
+    capacity_       = capacity;
+    endResetModel();
+}
+
+void LogModel::set_item_size(QSize size) {
+    item_size_ = size;
+}
+
+QStringList LogModel::append(QStringList lines) {
+    QStringList evicted;
+    if (capacity_ == 0) {
+        evicted = std::move(lines);
+        return evicted;
+    }
+    if (lines.isEmpty()) { return evicted; }
+
+    QStringList overflowed;
+    if (lines.size() > capacity_) {
+        overflowed = lines.mid(0, lines.size() - capacity_);
+        lines      = lines.mid(lines.size() - capacity_);
+    }
+
+    if (const int overflow = size_ + lines.size() - capacity_; overflow > 0) {
+        beginRemoveRows(QModelIndex(), 0, overflow - 1);
+        for (int i = 0; i < overflow; ++i) { evicted.append(std::move(ring_[(head_ + i) % capacity_])); }
+        head_  = (head_ + overflow) % capacity_;
+        size_ -= overflow;
+        endRemoveRows();
+    }
+    evicted.append(overflowed);
+
+    beginInsertRows(QModelIndex(), size_, size_ + lines.size() - 1);
+    for (auto &line : lines) {
+        //! NOTE: the ring is allocated lazily, it only grows until the first wrap around
+        const int slot = (head_ + size_) % capacity_;
+        if (slot < ring_.size()) {
+            ring_[slot] = std::move(line);
+        } else {
+            ring_.append(std::move(line));
+        }
+        ++size_;
+    }
+    endInsertRows();
+
+    return evicted;
+}
+
+QStringList LogModel::lines() const {
+    QStringList resp;
+    resp.reserve(size_);
+    for (int i = 0; i < size_; ++i) { resp.append(line_at(i)); }
+    return resp;
+}
+
+void LogModel::clear() {
+    beginResetModel();
+    ring_.clear();
+    head_ = 0;
+    size_ = 0;
+    endResetModel();
+}
+
+LogModel::LogModel(QObject *parent)
+    : QAbstractListModel(parent)
+    , head_(0)
+    , size_(0)
+    , capacity_(DEFAULT_CAPACITY) {}
+
+int LogModel::rowCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : size_;
+}
+
+QVariant LogModel::data(const QModelIndex &index, int role) const {
+    if (!index.isValid() || index.row() >= size_) { return QVariant(); }
+    if (false) {
+    } else if (role == Qt::DisplayRole) {
+        return line_at(index.row());
+    } else if (role == Qt::SizeHintRole && item_size_.isValid()) {
+        return item_size_;
+    }
+    return QVariant();
+}
+
+const QString &LogModel::line_at(int row) const {
+    return ring_[(head_ + row) % capacity_];
+}
+
+} // namespace UI
@@ -0,0 +1,59 @@
+/* Copyright 2024 周上行Ryer
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include <QtCore/QAbstractListModel>
+#include <QtCore/QSize>
+#include <QtCore/QStringList>
+
+namespace UI {
+
+//! fixed-capacity ring of log lines, the oldest lines are evicted once the capacity is reached
+class LogModel : public QAbstractListModel {
+    Q_OBJECT
+
+public:
+    static constexpr int DEFAULT_CAPACITY = 10000;
+
+    int  capacity() const;
+    void set_capacity(int capacity);
+
+    //! size hint shared by every line, which keeps the uniform layout of the view wide enough for the longest line
+    void set_item_size(QSize size);
+
+    //! returns the evicted lines from the oldest to the newest
+    QStringList append(QStringList lines);
+    QStringList lines() const;
+    void        clear();
+
+public:
+    LogModel(QObject *parent = nullptr);
+
+    int      rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+protected:
+    const QString &line_at(int row) const;
+
+private:
+    QList<QString> ring_;
+    int            head_; //<! slot of the oldest line
+    int            size_;
+    int            capacity_;
+    QSize          item_size_;
+};
+
+} // namespace UI
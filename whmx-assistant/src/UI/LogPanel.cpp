@@ -17,7 +17,13 @@
 #include "Scrollbar.h"
 
 #include <QtWidgets/QVBoxLayout>
+#include <QtWidgets/QScrollBar>
+#include <QtGui/QAction>
+#include <QtGui/QClipboard>
+#include <QtGui/QGuiApplication>
+#include <QtCore/QMetaMethod>
 #include <qtmaterialscrollbar.h>
+#include <algorithm>
 #include <shared_mutex>
 
 namespace UI {
@@ -31,8 +37,9 @@ QList<LogPanel *> LogPanel::global_logger_panels() {
     return std::move(resp);
 }
 
-void LogPanel::log(LogPanel *panel, const QString &message) {
-    QMetaObject::invokeMethod(panel, "log", Qt::AutoConnection, Q_ARG(QString, message));
+void LogPanel::log_to_global_panels(const QString &message) {
+    std::shared_lock lock(GLOBAL_LOG_PANELS_LOCK);
+    for (const auto panel : GLOBAL_LOG_PANELS) { panel->log(message); }
 }
 
 void LogPanel::attach_to_global_logger() {
@@ -46,40 +53,31 @@ void LogPanel::detach_from_global_logger() const {
 }
 
 void LogPanel::log(QString message) {
-    if (max_log_len_ == 0) { return; }
-
-    std::lock_guard lock(log_mutex_);
-
-    auto      vert_scrollbar          = log_text_container_->verticalScrollBar();
-    auto      hori_scrollbar          = log_text_container_->horizontalScrollBar();
-    const int last_scroll_vpos        = vert_scrollbar->sliderPosition();
-    const int last_scroll_hpos        = hori_scrollbar->sliderPosition();
-    bool      should_scroll           = last_scroll_vpos == vert_scrollbar->maximum();
-    bool      should_keep_hori_scroll = !vert_scrollbar->isVisible() || !should_scroll;
-
-    if (max_log_len_ > 0 && log_text_container_->toPlainText().length() > max_log_len_) {
-        flush();
-        should_scroll           = true;
-        should_keep_hori_scroll = false;
-    }
-
-    log_text_container_->moveCursor(QTextCursor::End, QTextCursor::MoveAnchor);
-    log_text_container_->insertPlainText(message);
-
-    if (should_scroll) {
-        vert_scrollbar->setSliderPosition(vert_scrollbar->maximum());
-    } else {
-        vert_scrollbar->setSliderPosition(last_scroll_vpos);
+    auto lines = message.split('\n');
+    if (lines.size() > 1 && lines.last().isEmpty()) { lines.removeLast(); }
+
+    //! NOTE: this may be called from any thread, only queue the lines here and leave the view to the append timer
+    bool should_schedule = false;
+    {
+        std::lock_guard lock(log_mutex_);
+        pending_lines_.append(std::move(lines));
+        should_schedule   = !append_scheduled_;
+        append_scheduled_ = true;
     }
-    if (should_keep_hori_scroll) { hori_scrollbar->setSliderPosition(last_scroll_hpos); }
+    if (should_schedule) { QMetaObject::invokeMethod(append_timer_, "start", Qt::AutoConnection); }
 }
 
 void LogPanel::clear() {
-    log_text_container_->clear();
+    {
+        std::lock_guard lock(log_mutex_);
+        pending_lines_.clear();
+    }
+    log_model_->clear();
 }
 
 QString LogPanel::take() {
-    auto loggings = log_text_container_->toPlainText();
+    append_pending();
+    auto loggings = log_model_->lines().join('\n');
     clear();
     return loggings;
 }
@@ -88,13 +86,14 @@ void LogPanel::flush() {
     emit on_flush(take());
 }
 
-void LogPanel::set_max_len(int max_len) {
-    max_log_len_ = max_len;
+void LogPanel::set_capacity(int max_lines) {
+    log_model_->set_capacity(max_lines);
 }
 
 LogPanel::LogPanel(QWidget *parent)
     : QWidget(parent)
-    , max_log_len_(-1) {
+    , append_scheduled_(false)
+    , max_line_width_(0) {
     setup();
 }
 
@@ -103,18 +102,76 @@ LogPanel::~LogPanel() {
 }
 
 void LogPanel::setup() {
-    log_text_container_ = new QPlainTextEdit;
-    log_text_container_->setReadOnly(true);
-    log_text_container_->setLineWrapMode(QPlainTextEdit::NoWrap);
-    log_text_container_->setHorizontalScrollBar(new Scrollbar);
-    log_text_container_->setVerticalScrollBar(new Scrollbar);
-    log_text_container_->setFrameShadow(QFrame::Raised);
-    log_text_container_->setFrameShape(QFrame::Box);
-    log_text_container_->setSizePolicy(QSizePolicy::MinimumExpanding, QSizePolicy::MinimumExpanding);
+    log_model_ = new LogModel(this);
+
+    log_view_ = new QListView;
+    log_view_->setModel(log_model_);
+    log_view_->setUniformItemSizes(true);
+    log_view_->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    log_view_->setSelectionMode(QAbstractItemView::ExtendedSelection);
+    log_view_->setHorizontalScrollMode(QAbstractItemView::ScrollPerPixel);
+    log_view_->setTextElideMode(Qt::ElideNone);
+    log_view_->setHorizontalScrollBar(new Scrollbar);
+    log_view_->setVerticalScrollBar(new Scrollbar);
+    log_view_->setFrameShadow(QFrame::Raised);
+    log_view_->setFrameShape(QFrame::Box);
+    log_view_->setSizePolicy(QSizePolicy::MinimumExpanding, QSizePolicy::MinimumExpanding);
+
+    auto copy_action = new QAction(log_view_);
+    copy_action->setShortcut(QKeySequence::Copy);
+    copy_action->setShortcutContext(Qt::WidgetShortcut);
+    log_view_->addAction(copy_action);
+
+    append_timer_ = new QTimer(this);
+    append_timer_->setSingleShot(true);
+    append_timer_->setInterval(APPEND_INTERVAL_MS);
 
     auto layout = new QVBoxLayout(this);
     layout->setContentsMargins({});
-    layout->addWidget(log_text_container_);
+    layout->addWidget(log_view_);
+
+    connect(append_timer_, &QTimer::timeout, this, &LogPanel::append_pending);
+    connect(copy_action, &QAction::triggered, this, &LogPanel::copy_selection);
+}
+
+void LogPanel::append_pending() {
+    QStringList lines;
+    {
+        std::lock_guard lock(log_mutex_);
+        lines.swap(pending_lines_);
+        append_scheduled_ = false;
+    }
+    if (lines.isEmpty()) { return; }
+
+    auto       vert_scrollbar = log_view_->verticalScrollBar();
+    const bool should_scroll  = vert_scrollbar->value() == vert_scrollbar->maximum();
+
+    //! NOTE: the view lays out every line with the size of a single item, so track the widest line seen so far
+    const auto metrics   = log_view_->fontMetrics();
+    int        max_width = max_line_width_;
+    for (const auto &line : lines) { max_width = std::max(max_width, metrics.horizontalAdvance(line)); }
+    if (max_width > max_line_width_) {
+        max_line_width_ = max_width;
+        log_model_->set_item_size(QSize(max_line_width_ + metrics.averageCharWidth() * 2, metrics.height()));
+    }
+
+    const auto evicted = log_model_->append(std::move(lines));
+    if (!evicted.isEmpty() && isSignalConnected(QMetaMethod::fromSignal(&LogPanel::on_flush))) {
+        emit on_flush(evicted.join('\n'));
+    }
+
+    if (should_scroll) { log_view_->scrollToBottom(); }
+}
+
+void LogPanel::copy_selection() {
+    auto selected = log_view_->selectionModel()->selectedRows();
+    std::sort(selected.begin(), selected.end(), [](const QModelIndex &lhs, const QModelIndex &rhs) {
+        return lhs.row() < rhs.row();
+    });
+
+    QStringList lines;
+    for (const auto &index : selected) { lines.append(index.data().toString()); }
+    QGuiApplication::clipboard()->setText(lines.join('\n'));
 }
 
 } // namespace UI
@@ -15,7 +15,10 @@
 
 #pragma once
 
-#include <QtWidgets/QPlainTextEdit>
+#include "LogModel.h"
+
+#include <QtWidgets/QListView>
+#include <QtCore/QTimer>
 #include <QtCore/QList>
 #include <mutex>
 
@@ -25,8 +28,14 @@ class LogPanel : public QWidget {
     Q_OBJECT
 
 public:
+    static constexpr int APPEND_INTERVAL_MS = 16; //<! appends are coalesced into one batch per frame
+
     static QList<LogPanel *> global_logger_panels();
-    static void              log(LogPanel *panel, const QString &message);
+
+    //! log the message to every attached panel, may be called from any thread
+    //! NOTE: the panels are visited under the registry lock, detach_from_global_logger waits for an in-flight dispatch
+    //! so that a panel being destroyed is never touched
+    static void log_to_global_panels(const QString &message);
 
     void attach_to_global_logger();
     void detach_from_global_logger() const;
@@ -34,7 +43,7 @@ public:
     void    clear();
     QString take();
     void    flush();
-    void    set_max_len(int max_len);
+    void    set_capacity(int max_lines);
 
 public slots:
     void log(QString message);
@@ -48,11 +57,17 @@ public:
 
 protected:
     void setup();
+    void append_pending();
+    void copy_selection();
 
 private:
-    QPlainTextEdit *log_text_container_ = nullptr;
-    std::mutex      log_mutex_;
-    int             max_log_len_;
+    QListView  *log_view_     = nullptr;
+    LogModel   *log_model_    = nullptr;
+    QTimer     *append_timer_ = nullptr;
+    std::mutex  log_mutex_;
+    QStringList pending_lines_; //<! guarded by log_mutex_
+    bool        append_scheduled_;
+    int         max_line_width_;
 };
 
 } // namespace UI
@@ -31,13 +31,15 @@
 #include <magic_enum.hpp>
 #include <qtmaterialscrollbar.h>
 #include <ElaContentDialog.h>
+#include <algorithm>
 
 using namespace maa;
 
 namespace UI {
 
-void Workbench::pop_first_queued_task() {
-    ui_task_queue_->takeItem(0);
+void Workbench::take_queued_task(QListWidgetItem *item) {
+    //! NOTE: the item may have been dropped from the queue while it was running
+    if (const int row = item ? ui_task_queue_->row(item) : -1; row >= 0) { ui_task_queue_->takeItem(row); }
 }
 
 void Workbench::clear_queued_tasks() {
@@ -49,9 +51,9 @@ void Workbench::accept_maa_instance(std::shared_ptr<maa::Instance> instance) {
         LOG_ERROR() << "accepted invalid maa instance";
         return;
     }
-    if (instance_) { LOG_INFO() << "override current exisiting maa instance"; }
-    instance_ = instance;
-    LOG_INFO() << "workbench: accepted maa instance";
+    if (instances_.contains(instance)) { return; }
+    instances_.append(instance);
+    LOG_INFO() << "workbench: accepted maa instance," << instances_.size() << "instances in total";
     LOG_INFO(Workstation) << "设备连接成功";
 }
 
@@ -178,6 +180,7 @@ void Workbench::notify_queued_task_finished(const QString &task_id, MaaStatus st
         return;
     }
     pending_task_accepted_.remove(task_id);
+    const auto item = posted_tasks_.take(task_id);
     if (status == MaaStatus_Success) {
         LOG_INFO().noquote() << "posted queued task" << task_id << "resolved successfully";
     } else {
@@ -185,12 +188,15 @@ void Workbench::notify_queued_task_finished(const QString &task_id, MaaStatus st
         LOG_INFO().noquote() << "skip failed queued task" << task_id;
         LOG_WARN(Workstation) << "任务执行失败，已跳过";
     }
-    pop_first_queued_task();
+    take_queued_task(item);
     post_next_queued_task();
 }
 
 void Workbench::start_pipeline() {
-    if (!instance_ || !instance_->inited()) {
+    const bool has_valid_instance = std::any_of(instances_.begin(), instances_.end(), [](const auto &instance) {
+        return instance->inited();
+    });
+    if (!has_valid_instance) {
         LOG_WARN() << "workbench: failed to start pipeline: no valid maa instance accepted";
         Notification::error(this, "启动流水线", "缺少有效 MAA 实例，请检查本地资源完整性并确保已连接至设备");
         return;
@@ -226,8 +232,10 @@ void Workbench::stop_pipeline() {
         LOG_WARN() << "pipeline is already stopped";
         return;
     }
+    emit on_stop_pipeline();
     pause_pipeline([this] {
         pending_task_accepted_.clear();
+        posted_tasks_.clear();
         pipeline_state_ = PipelineState_Idle;
         LOG_INFO() << "pipeline stopped";
         LOG_INFO(Workstation) << "流水线已暂停";
@@ -254,10 +262,11 @@ void Workbench::pause_pipeline(std::optional<std::function<void()>> opt_on_pause
         while (!done) {
             tm.restart();
             while (tm.elapsed() < 500 && !done) {
-                //! ATTENTION: instance_->running() is unreliable
+                //! ATTENTION: instance->running() is unreliable
                 //! FIXME: stop only stop the PIPELINE, that means the current task will run to the end, manully terminate the
                 //! task is expected
-                done = instance_->stop();
+                done = true;
+                for (const auto &instance : instances_) { done = instance->stop() && done; }
             }
             if (done) { break; }
             std::this_thread::yield();
@@ -282,16 +291,27 @@ void Workbench::resume_pipeline() {
 }
 
 void Workbench::post_next_queued_task() {
-    if (ui_task_queue_->count() == 0) {
-        LOG_INFO() << "post queued task: no more tasks found in task queue";
-        stop_pipeline();
+    //! NOTE: keep one task in flight per device, the client spreads them across the devices
+    const auto posted_items = posted_tasks_.values();
+    int        index        = 0;
+    while (index < ui_task_queue_->count() && posted_items.contains(ui_task_queue_->item(index))) { ++index; }
+
+    if (index == ui_task_queue_->count()) {
+        if (posted_tasks_.empty()) {
+            LOG_INFO() << "post queued task: no more tasks found in task queue";
+            stop_pipeline();
+        }
         return;
     }
-    const auto task_item = qobject_cast<QueuedTaskItem *>(ui_task_queue_->itemWidget(ui_task_queue_->item(0)));
+    if (posted_tasks_.size() >= std::max<qsizetype>(instances_.size(), 1)) { return; }
+
+    const auto item      = ui_task_queue_->item(index);
+    const auto task_item = qobject_cast<QueuedTaskItem *>(ui_task_queue_->itemWidget(item));
     const auto task_id   = QUuid::createUuid().toString();
     const auto task = task_item->task_type() == QueuedTaskItem::MajorTask ? QVariant::fromValue(task_item->major_task().value())
                                                                           : QVariant::fromValue(task_item->task_name());
     pending_task_accepted_[task_id] = false;
+    posted_tasks_[task_id]          = item;
 
     LOG_INFO().noquote().nospace() << "post queued task " << task << " [task_id=" << task_id << "]";
 
@@ -300,6 +320,8 @@ void Workbench::post_next_queued_task() {
         if (!pending_task_accepted_.value(task_id, true)) { handle_on_cancel_posted_queued_task(task_id); }
     });
     emit on_post_queued_task(task_id, std::move(task));
+
+    post_next_queued_task();
 }
 
 void Workbench::handle_on_pending_pipeline_pause_done() {
@@ -311,6 +333,7 @@ void Workbench::handle_on_cancel_posted_queued_task(const QString &task_id) {
     if (!pending_task_accepted_.contains(task_id)) { return; }
     LOG_WARN().noquote() << "no resolver found, cancel posted queued task" << task_id;
     pending_task_accepted_.remove(task_id);
+    posted_tasks_.remove(task_id);
     stop_pipeline();
 }
 
@@ -568,6 +591,7 @@ void Workbench::setup() {
     connect(this, &Workbench::on_open_maa_log_file, event, &AppEvent::workbench_on_open_maa_log_file);
     connect(this, &Workbench::on_open_app_log_file, event, &AppEvent::workbench_on_open_app_log_file);
     connect(this, &Workbench::on_post_queued_task, event, &AppEvent::workbench_on_post_queued_task);
+    connect(this, &Workbench::on_stop_pipeline, event, &AppEvent::workbench_on_stop_pipeline);
     connect(this, &Workbench::on_request_open_task_config_panel, event, &AppEvent::workbench_on_request_open_task_config_panel);
     connect(event, &AppEvent::workbench_on_notify_queued_task_accepted, this, &Workbench::notify_queued_task_accepted);
     connect(event, &AppEvent::workbench_on_notify_queued_task_finished, this, &Workbench::notify_queued_task_finished);
@@ -86,7 +86,7 @@ public:
     }
 
 protected:
-    void    pop_first_queued_task();
+    void    take_queued_task(QListWidgetItem *item);
     void    clear_queued_tasks();
     void    accept_maa_instance(std::shared_ptr<maa::Instance> instance);
     void    set_list_item_widget_checked(QListWidgetItem *item, bool on);
@@ -148,24 +148,25 @@ protected:
     void setup();
 
 private:
-    QMap<QString, bool>            pending_task_accepted_;
-    PipelineState                  pipeline_state_;
-    maa::coro::Promise<void>       fut_pending_pause_;
-    std::shared_ptr<maa::Instance> instance_;
-    QCheckBox                     *ui_major_tasks_select_all_  = nullptr;
-    QListWidget                   *ui_major_task_list_         = nullptr;
-    QtMaterialTextField           *ui_major_task_filter_       = nullptr;
-    QCheckBox                     *ui_custom_tasks_select_all_ = nullptr;
-    QListWidget                   *ui_custom_task_list_        = nullptr;
-    QtMaterialTextField           *ui_custom_task_filter_      = nullptr;
-    QListWidget                   *ui_task_queue_              = nullptr;
-    FlatButton                    *ui_reload_custom_tasks_     = nullptr;
-    FlatButton                    *ui_join_tasks_              = nullptr;
-    FlatButton                    *ui_start_pipeline_          = nullptr;
-    FlatButton                    *ui_pause_pipeline_          = nullptr;
-    LogPanel                      *ui_log_panel_               = nullptr;
-    FlatButton                    *ui_open_maa_log_file_       = nullptr;
-    FlatButton                    *ui_open_app_log_file_       = nullptr;
+    QMap<QString, bool>                   pending_task_accepted_;
+    QMap<QString, QListWidgetItem *>      posted_tasks_; //<! queued tasks which are posted but not finished yet
+    PipelineState                         pipeline_state_;
+    maa::coro::Promise<void>              fut_pending_pause_;
+    QList<std::shared_ptr<maa::Instance>> instances_;    //<! one per connected device
+    QCheckBox                            *ui_major_tasks_select_all_  = nullptr;
+    QListWidget                          *ui_major_task_list_         = nullptr;
+    QtMaterialTextField                  *ui_major_task_filter_       = nullptr;
+    QCheckBox                            *ui_custom_tasks_select_all_ = nullptr;
+    QListWidget                          *ui_custom_task_list_        = nullptr;
+    QtMaterialTextField                  *ui_custom_task_filter_      = nullptr;
+    QListWidget                          *ui_task_queue_              = nullptr;
+    FlatButton                           *ui_reload_custom_tasks_     = nullptr;
+    FlatButton                           *ui_join_tasks_              = nullptr;
+    FlatButton                           *ui_start_pipeline_          = nullptr;
+    FlatButton                           *ui_pause_pipeline_          = nullptr;
+    LogPanel                             *ui_log_panel_               = nullptr;
+    FlatButton                           *ui_open_maa_log_file_       = nullptr;
+    FlatButton                           *ui_open_app_log_file_       = nullptr;
 };
 
 } // namespace UI
@@ -0,0 +1,114 @@
+/* Copyright 2024 周上行Ryer
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "Watchdog.h"
+
+Watchdog &Watchdog::instance() {
+    static Watchdog instance;
+    return instance;
+}
+
+Watchdog::Watchdog()
+    : stopped_(false)
+    , next_ticket_(1)
+    , firing_ticket_(0) {
+    watch_thread_ = std::thread(&Watchdog::watch_loop, this);
+}
+
+Watchdog::~Watchdog() {
+    stop();
+}
+
+Watchdog::Ticket Watchdog::arm(std::chrono::milliseconds budget, std::function<void()> on_expired) {
+    bool   earliest = false;
+    Ticket ticket   = 0;
+    {
+        std::lock_guard lock(lock_);
+        if (stopped_) { return 0; }
+        ticket = next_ticket_++;
+        handlers_.emplace(ticket, std::move(on_expired));
+        const auto at = Clock::now() + budget;
+        earliest      = deadlines_.empty() || at < deadlines_.top().at;
+        deadlines_.push(Deadline{at, ticket});
+    }
+    //! NOTE: the timer thread only needs a wakeup when the new deadline is ahead of the one it is sleeping on
+    if (earliest) { cond_.notify_one(); }
+    return ticket;
+}
+
+void Watchdog::cancel(Ticket ticket) {
+    if (ticket == 0) { return; }
+    std::unique_lock lock(lock_);
+    handlers_.erase(ticket);
+
+    //! NOTE: the handler may cancel its own ticket, waiting for it on the watchdog thread would never return
+    if (std::this_thread::get_id() != watch_thread_.get_id()) {
+        fired_cond_.wait(lock, [this, ticket] {
+            return firing_ticket_ != ticket;
+        });
+    }
+
+    //! NOTE: keep the heap from piling up with cancelled deadlines when long budgets are cancelled frequently
+    if (deadlines_.size() > handlers_.size() * 2 + 64) {
+        std::vector<Deadline> live;
+        live.reserve(handlers_.size());
+        while (!deadlines_.empty()) {
+            if (handlers_.contains(deadlines_.top().ticket)) { live.push_back(deadlines_.top()); }
+            deadlines_.pop();
+        }
+        deadlines_ = decltype(deadlines_)(std::greater<>(), std::move(live));
+    }
+}
+
+void Watchdog::stop() {
+    {
+        std::lock_guard lock(lock_);
+        if (stopped_) { return; }
+        stopped_ = true;
+        handlers_.clear();
+    }
+    cond_.notify_all();
+    if (watch_thread_.joinable()) { watch_thread_.join(); }
+}
+
+void Watchdog::watch_loop() {
+    std::unique_lock lock(lock_);
+    while (!stopped_) {
+        if (deadlines_.empty()) {
+            cond_.wait(lock);
+            continue;
+        }
+
+        const auto next = deadlines_.top();
+        if (Clock::now() < next.at) {
+            cond_.wait_until(lock, next.at);
+            continue;
+        }
+
+        deadlines_.pop();
+        const auto it = handlers_.find(next.ticket);
+        if (it == handlers_.end()) { continue; }
+        auto handler = std::move(it->second);
+        handlers_.erase(it);
+        firing_ticket_ = next.ticket;
+
+        lock.unlock();
+        handler();
+        lock.lock();
+
+        firing_ticket_ = 0;
+        fired_cond_.notify_all();
+    }
+}
@@ -0,0 +1,91 @@
+/* Copyright 2024 周上行Ryer
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+//! process-wide watchdog which runs a handler once a deadline expires, all deadlines share a single timer thread
+//! NOTE: arming and cancelling only touch a min-heap and a map under a short lock, cancelled deadlines are dropped
+//! lazily when they reach the top of the heap, cancelling only waits when it races with the handler of its own ticket
+class Watchdog {
+public:
+    using Ticket = uint64_t; //<! 0 is never a valid ticket
+
+    static constexpr auto DEFAULT_BUDGET = std::chrono::minutes(5);
+
+    static Watchdog &instance();
+
+    ~Watchdog();
+
+    //! the handler runs on the watchdog thread when the budget is used up, unless the ticket is cancelled ahead
+    Ticket arm(std::chrono::milliseconds budget, std::function<void()> on_expired);
+    //! NOTE: blocks until the handler of the ticket returns if it is already running, so that a late handler never
+    //! reaches into whatever the caller starts after cancelling
+    void   cancel(Ticket ticket);
+    void   stop();
+
+protected:
+    Watchdog();
+
+    void watch_loop();
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Deadline {
+        Clock::time_point at;
+        Ticket            ticket;
+
+        bool operator>(const Deadline &other) const {
+            return at > other.at;
+        }
+    };
+
+    std::mutex                                                           lock_;
+    std::condition_variable                                              cond_;
+    std::condition_variable                                              fired_cond_;
+    bool                                                                 stopped_;
+    Ticket                                                               next_ticket_;
+    Ticket                                                               firing_ticket_; //<! 0 if no handler is running
+    std::priority_queue<Deadline, std::vector<Deadline>, std::greater<>> deadlines_;
+    std::unordered_map<Ticket, std::function<void()>>                    handlers_; //<! live tickets only
+    std::thread                                                          watch_thread_;
+};
+
+//! arms the watchdog for the lifetime of the guard
+class WatchdogGuard {
+public:
+    WatchdogGuard(std::chrono::milliseconds budget, std::function<void()> on_expired)
+        : ticket_(Watchdog::instance().arm(budget, std::move(on_expired))) {}
+
+    ~WatchdogGuard() {
+        Watchdog::instance().cancel(ticket_);
+    }
+
+    WatchdogGuard(const WatchdogGuard &)            = delete;
+    WatchdogGuard &operator=(const WatchdogGuard &) = delete;
+
+private:
+    Watchdog::Ticket ticket_;
+};